@@ -15,6 +15,7 @@
 #include <eosio.system/staking_pool.hpp>
 
 #include <deque>
+#include <map>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -84,6 +85,14 @@ namespace eosiosystem {
    static constexpr int64_t  default_inflation_pay_factor  = 50000;   // producers pay share = 10000 / 50000 = 20% of the inflation
    static constexpr int64_t  default_votepay_factor        = 40000;   // per-block pay share = 10000 / 40000 = 25% of the producer pay
 
+   // Estimated cost of keeper work items in work units, roughly one unit per table row written
+   static constexpr uint32_t rex_loan_work_units      = 4;  // close or renew an expired REX loan
+   static constexpr uint32_t rex_order_work_units     = 2;  // examine a queued sellrex order
+   static constexpr uint32_t powerup_order_work_units = 3;  // expire a powerup order
+
+   static constexpr int64_t  rex_vote_sync_divisor   = 100; // queue REX vote stake drift once it reaches 1% of voter stake
+   static constexpr uint16_t rex_vote_sync_per_block = 2;   // queued REX voters settled by every onblock
+
    // A name bid, which consists of:
    // - a `newname` name that the bid is for
    // - a `high_bidder` account name that is the one with the highest bid so far
@@ -102,6 +111,8 @@ namespace eosiosystem {
    // A bid refund, which is defined by:
    // - the `bidder` account name owning the refund
    // - the `amount` to be refunded
+   // Rows scoped by the system account hold a bidder's outbid amounts across all names; rows
+   // scoped by a name were created before refunds were pooled and are claimed with `bidrefund`.
    struct [[eosio::table, eosio::contract("eosio.system")]] bid_refund {
       name         bidder;
       asset        amount;
@@ -112,8 +123,35 @@ namespace eosiosystem {
                                indexed_by<"highbid"_n, const_mem_fun<name_bid, uint64_t, &name_bid::by_high_bid>  >
                              > name_bid_table;
 
+   // Closed auctions waiting for the winner to create the account, moved out of `namebids` so that its
+   // `highbid` index only holds open auctions. `high_bid` is negative as it is for closed auctions that
+   // were left in `namebids` before this table existed.
+   typedef eosio::multi_index< "closedbids"_n, name_bid > closed_name_bid_table;
+
    typedef eosio::multi_index< "bidrefunds"_n, bid_refund > bid_refund_table;
 
+   // One open auction in the name bid leaderboard
+   struct name_bid_summary {
+      name            newname;
+      name            high_bidder;
+      int64_t         high_bid = 0;
+      time_point      last_bid_time;
+
+      EOSLIB_SERIALIZE( name_bid_summary, (newname)(high_bidder)(high_bid)(last_bid_time) )
+   };
+
+   // The open auctions with the highest bids, highest first, in the order of the `highbid` index.
+   // Kept up to date by `bidname` and by the daily auction close, which reads the first entry.
+   struct [[eosio::table("namebidtop"), eosio::contract("eosio.system")]] name_bid_leaderboard {
+      static constexpr uint32_t max_size = 10;
+
+      std::vector<name_bid_summary> top;
+
+      EOSLIB_SERIALIZE( name_bid_leaderboard, (top) )
+   };
+
+   typedef eosio::singleton< "namebidtop"_n, name_bid_leaderboard > name_bid_leaderboard_singleton;
+
    // Defines new global state parameters.
    struct [[eosio::table("global"), eosio::contract("eosio.system")]] eosio_global_state : eosio::blockchain_parameters {
       uint64_t free_ram()const { return max_ram_size - total_ram_bytes_reserved; }
@@ -263,6 +301,7 @@ namespace eosiosystem {
    // - `proxy` the proxy set by the voter, if any
    // - `producers` the producers approved by this voter if no proxy set
    // - `staked` the amount staked
+   // - `unsynced_rex_stake` REX vote stake added to `staked` since producer or proxy votes were last recalculated
    struct [[eosio::table, eosio::contract("eosio.system")]] voter_info {
       name                owner;     /// the voter
       name                proxy;     /// the proxy set by the voter, if any
@@ -281,7 +320,7 @@ namespace eosiosystem {
 
       uint32_t            flags1 = 0;
       uint32_t            reserved2 = 0;
-      eosio::asset        reserved3;
+      eosio::asset        unsynced_rex_stake; /// formerly reserved3, only the amount is used
 
       uint64_t primary_key()const { return owner.value; }
 
@@ -292,7 +331,7 @@ namespace eosiosystem {
       };
 
       // explicit serialization macro is not necessary, used here only to improve compilation time
-      EOSLIB_SERIALIZE( voter_info, (owner)(proxy)(producers)(staked)(last_vote_weight)(proxied_vote_weight)(is_proxy)(flags1)(reserved2)(reserved3) )
+      EOSLIB_SERIALIZE( voter_info, (owner)(proxy)(producers)(staked)(last_vote_weight)(proxied_vote_weight)(is_proxy)(flags1)(reserved2)(unsynced_rex_stake) )
    };
 
 
@@ -314,6 +353,32 @@ namespace eosiosystem {
 
    typedef eosio::singleton< "global4"_n, eosio_global_state4 > global_state4_singleton;
 
+   // Time-weighted price accumulator of the ram market. Before the ram market reserves change,
+   // `price_cumulative` is increased by the price set by the previous reserves times the seconds
+   // since `last_update`. The average price over a window is the difference of two reads of
+   // `price_cumulative` divided by the difference of their `last_update`, shifted right by
+   // `price_fraction_bits` to get core token units per byte.
+   struct [[eosio::table("ramtwap"), eosio::contract("eosio.system")]] ram_price_accumulator {
+      static constexpr uint32_t price_fraction_bits = 32;
+
+      uint8_t          version = 0;
+      time_point_sec   last_update;
+      uint128_t        price_cumulative = 0;   // sum of price × seconds, price in core token units per byte with
+                                               // `price_fraction_bits` fractional bits; wraps on overflow
+   };
+
+   typedef eosio::singleton< "ramtwap"_n, ram_price_accumulator > ram_price_accumulator_singleton;
+
+   // Options for accounts created through `newaccount`, set with `cfgnewacct`
+   struct [[eosio::table("newacctcfg"), eosio::contract("eosio.system")]] new_account_config {
+      bool             defer_userres = false;   // create the `userres` row of a new account with its first
+                                                // purchase of resources instead of in `newaccount`
+
+      EOSLIB_SERIALIZE( new_account_config, (defer_userres) )
+   };
+
+   typedef eosio::singleton< "newacctcfg"_n, new_account_config > new_account_config_singleton;
+
    struct [[eosio::table, eosio::contract("eosio.system")]] user_resources {
       name          owner;
       asset         net_weight;
@@ -342,6 +407,17 @@ namespace eosiosystem {
 
    };
 
+   // Reverse index of `delband`: scoped by the receiver, one row per account delegating bandwidth to it.
+   // Delegations to self are not indexed; the row is paid for by the delegator.
+   struct [[eosio::table, eosio::contract("eosio.system")]] bw_delegator {
+      name          from;
+
+      uint64_t  primary_key()const { return from.value; }
+
+      // explicit serialization macro is not necessary, used here only to improve compilation time
+      EOSLIB_SERIALIZE( bw_delegator, (from) )
+   };
+
    struct [[eosio::table, eosio::contract("eosio.system")]] refund_request {
       name            owner;
       time_point_sec  request_time;
@@ -356,10 +432,75 @@ namespace eosiosystem {
    };
 
 
+   // One receiver of a `buyrambatch` purchase
+   struct ram_purchase {
+      name          receiver;
+      uint32_t      bytes;
+
+      EOSLIB_SERIALIZE( ram_purchase, (receiver)(bytes) )
+   };
+
+   // One receiver of a `delegatebws` delegation
+   struct bw_delegation {
+      name          receiver;
+      asset         stake_net_quantity;
+      asset         stake_cpu_quantity;
+
+      EOSLIB_SERIALIZE( bw_delegation, (receiver)(stake_net_quantity)(stake_cpu_quantity) )
+   };
+
+   // Resource limits of one account set by `setacctlims`; an empty field leaves that resource unmanaged,
+   // at its staked amount if it was managed and at its current limit otherwise
+   struct account_limits {
+      name                      account;
+      std::optional<int64_t>    ram_bytes;
+      std::optional<int64_t>    net_weight;
+      std::optional<int64_t>    cpu_weight;
+
+      EOSLIB_SERIALIZE( account_limits, (account)(ram_bytes)(net_weight)(cpu_weight) )
+   };
+
+   // Resources bought by `onboard` for the account created by its inline `newaccount`. The `newaccount`
+   // handler applies them when it creates the account's `userres` row, then erases this row.
+   struct [[eosio::table, eosio::contract("eosio.system")]] pending_onboarding {
+      name          account;
+      int64_t       ram_bytes = 0;
+      asset         net_weight;
+      asset         cpu_weight;
+      bool          transfer = false;   // the stake belongs to `account` instead of being delegated by its creator
+
+      uint64_t primary_key()const { return account.value; }
+
+      // explicit serialization macro is not necessary, used here only to improve compilation time
+      EOSLIB_SERIALIZE( pending_onboarding, (account)(ram_bytes)(net_weight)(cpu_weight)(transfer) )
+   };
+
+   typedef eosio::multi_index< "onboarding"_n, pending_onboarding > pending_onboarding_table;
+
    typedef eosio::multi_index< "userres"_n, user_resources >      user_resources_table;
    typedef eosio::multi_index< "delband"_n, delegated_bandwidth > del_bandwidth_table;
+   typedef eosio::multi_index< "delegators"_n, bw_delegator >    bw_delegator_table;
    typedef eosio::multi_index< "refunds"_n, refund_request >      refunds_table;
 
+   // Pending refunds of all owners ordered by request time, so the owners of matured refunds can be
+   // found and passed to `refundexec`. Rows are kept in step with the owners' `refunds` rows.
+   // `refunds` rows which were last changed before this table existed have no entry until the owner's
+   // next unstake; they are still paid out by `refund` and by `refundexec` when their owner is listed.
+   struct [[eosio::table, eosio::contract("eosio.system")]] refund_queue_entry {
+      name            owner;
+      time_point_sec  request_time;
+
+      uint64_t primary_key()const { return owner.value; }
+      uint64_t by_request_time()const { return request_time.utc_seconds; }
+
+      // explicit serialization macro is not necessary, used here only to improve compilation time
+      EOSLIB_SERIALIZE( refund_queue_entry, (owner)(request_time) )
+   };
+
+   typedef eosio::multi_index< "refundqueue"_n, refund_queue_entry,
+                               indexed_by<"byreqtime"_n, const_mem_fun<refund_queue_entry, uint64_t, &refund_queue_entry::by_request_time>>
+                             > refund_queue_table;
+
    // `rex_pool` structure underlying the rex pool table. A rex pool table entry is defined by:
    // - `version` defaulted to zero,
    // - `total_lent` total amount of CORE_SYMBOL in open rex_loans
@@ -443,6 +584,8 @@ namespace eosiosystem {
    // - `vote_stake` the amount of CORE_SYMBOL currently included in owner's vote,
    // - `rex_balance` the amount of REX owned by owner,
    // - `matured_rex` matured REX available for selling
+   // - `rex_maturities` REX daily maturity buckets. Only read when the entry is moved into `rex_account_info`,
+   //       whose maturities are bounded to `rex_account_info::maturity_slots` days; no action writes this table.
    struct [[eosio::table,eosio::contract("eosio.system")]] rex_balance {
       uint8_t version = 0;
       name    owner;
@@ -456,6 +599,41 @@ namespace eosiosystem {
 
    typedef eosio::multi_index< "rexbal"_n, rex_balance > rex_balance_table;
 
+   // `rex_account_info` structure underlying the consolidated rex account table. A rex account entry holds
+   // an owner's `rex_fund` and `rex_balance` entries in a single row. It replaces them the first time a
+   // REX action writes the owner's fund or balance, or when `migraterex` is called:
+   // - `version` defaulted to zero,
+   // - `owner` the owner of the rex account,
+   // - `fund` the balance of the rex fund, or an empty asset if owner has no rex fund,
+   // - `vote_stake` the amount of CORE_SYMBOL currently included in owner's vote,
+   // - `rex_balance` the amount of REX owned by owner, or an empty asset if owner has no rex balance,
+   // - `matured_rex` matured REX available for selling,
+   // - `matured_day` the last day, counted from the epoch, whose maturing REX was added to `matured_rex`,
+   // - `maturing_rex` REX maturing at the start of each of the `maturity_slots` days following `matured_day`,
+   //       with day `d` stored in slot `d % maturity_slots`,
+   // - `savings_rex` REX in the savings bucket, which never matures
+   struct [[eosio::table,eosio::contract("eosio.system")]] rex_account_info {
+      static constexpr uint32_t maturity_slots = 5;
+
+      uint8_t              version = 0;
+      name                 owner;
+      asset                fund;
+      asset                vote_stake;
+      asset                rex_balance;
+      int64_t              matured_rex = 0;
+      uint32_t             matured_day = 0;
+      std::vector<int64_t> maturing_rex = std::vector<int64_t>( maturity_slots, 0 );
+      int64_t              savings_rex = 0;
+
+      bool has_fund()const        { return fund.symbol.raw() != 0;        }
+      bool has_rex_balance()const { return rex_balance.symbol.raw() != 0; }
+      int64_t& maturing_on( uint32_t day )     { return maturing_rex[day % maturity_slots]; }
+      int64_t maturing_on( uint32_t day )const { return maturing_rex[day % maturity_slots]; }
+      uint64_t primary_key()const { return owner.value; }
+   };
+
+   typedef eosio::multi_index< "rexaccount"_n, rex_account_info > rex_account_table;
+
    // `rex_loan` structure underlying the `rex_cpu_loan_table` and `rex_net_loan_table`. A rex net/cpu loan table entry is defined by:
    // - `version` defaulted to zero,
    // - `from` account creating and paying for loan,
@@ -508,12 +686,67 @@ namespace eosiosystem {
    typedef eosio::multi_index< "rexqueue"_n, rex_order,
                                indexed_by<"bytime"_n, const_mem_fun<rex_order, uint64_t, &rex_order::by_time>>> rex_order_table;
 
+   // `rex_exec_cursor` structure underlying the rex keeper cursor singleton, which records where
+   // `rexexec2` stopped so the next call resumes there:
+   // - `version` defaulted to zero,
+   // - `stage` the category being processed: 0 for CPU loans, 1 for NET loans, 2 for sellrex orders,
+   // - `order_time` the `bytime` key of the next sellrex order to examine, 0 to start from the oldest one
+   struct [[eosio::table("rexcursor"),eosio::contract("eosio.system")]] rex_exec_cursor {
+      static constexpr uint8_t cpu_loans_stage   = 0;
+      static constexpr uint8_t net_loans_stage   = 1;
+      static constexpr uint8_t sell_orders_stage = 2;
+      static constexpr uint8_t num_stages        = 3;
+
+      uint8_t  version    = 0;
+      uint8_t  stage      = cpu_loans_stage;
+      uint64_t order_time = 0;
+
+      uint64_t primary_key()const { return 0; }
+   };
+
+   typedef eosio::singleton<"rexcursor"_n, rex_exec_cursor> rex_exec_cursor_singleton;
+
+   // `rex_vote_sync` structure underlying the rex vote sync table. An entry records a voter whose
+   // unsynced REX vote stake reached 1/`rex_vote_sync_divisor` of its stake. Entries are paid for by
+   // the system contract and are removed whenever the voter votes are recalculated:
+   // - `version` defaulted to zero,
+   // - `owner` the voter, whose votes are recalculated by `onblock`, `syncrexvotes` or the next vote update
+   struct [[eosio::table,eosio::contract("eosio.system")]] rex_vote_sync {
+      uint8_t version = 0;
+      name    owner;
+
+      uint64_t primary_key()const { return owner.value; }
+   };
+
+   typedef eosio::multi_index< "rexvotesync"_n, rex_vote_sync > rex_vote_sync_table;
+
    struct rex_order_outcome {
       bool success;
       asset proceeds;
       asset stake_change;
    };
 
+   // Per-action view of an owner's REX fund and balance. It is loaded once from either the `rexaccount`
+   // row or the legacy `rexfund` and `rexbal` rows, and written back to `rexaccount` when the contract
+   // is destroyed. All REX fund and balance accesses go through this view.
+   struct rex_account_cache {
+      rex_account_info acct;
+      bool             in_fund_table    = false;
+      bool             in_balance_table = false;
+      bool             in_account_table = false;
+      bool             fund_dirty       = false;
+      bool             balance_dirty    = false;
+   };
+
+   // Per-action view of an account's resource limits. It is loaded once with `get_resource_limits` and
+   // written back with a single `set_resource_limits` when the contract is destroyed.
+   struct resource_limits_cache {
+      int64_t ram_bytes = 0;
+      int64_t net_weight = 0;
+      int64_t cpu_weight = 0;
+      bool    dirty      = false;
+   };
+
    struct powerup_config_resource {
       std::optional<int64_t>        current_weight_ratio;   // Immediately set weight_ratio to this amount. 1x = 10^15. 0.01x = 10^13.
                                                             //    Do not specify to preserve the existing setting or use the default;
@@ -607,12 +840,38 @@ namespace eosiosystem {
       powerup_state_resource     cpu               = {};                     // CPU market state
       uint32_t                   powerup_days      = default_powerup_days;   // `powerup` `days` argument must match this.
       asset                      min_powerup_fee   = {};                     // fees below this amount are rejected
+      eosio::binary_extension<time_point_sec> last_history_sample;           // when `powup.hist` was last sampled
 
       uint64_t primary_key()const { return 0; }
    };
 
    typedef eosio::singleton<"powup.state"_n, powerup_state> powerup_state_singleton;
 
+   // A sample of one resource market
+   struct powerup_history_sample {
+      time_point_sec timestamp            = {};   // when the sample was taken
+      int64_t        utilization          = 0;    // instantaneous resource utilization
+      int64_t        adjusted_utilization = 0;    // adjusted resource utilization
+      int64_t        weight               = 0;    // resource market weight
+      int64_t        price                = 0;    // price p(u) at the adjusted utilization, i.e. the fee for the whole
+                                                  //    market weight at the current marginal price
+   };
+
+   // Ring buffers of market samples, taken by the powerup queue processing at most once per `sample_interval`
+   struct [[eosio::table("powup.hist"),eosio::contract("eosio.system")]] powerup_history {
+      static constexpr uint32_t max_samples     = 48;       // 24 hours of samples
+      static constexpr uint32_t sample_interval = 30 * 60;  // 30 minutes
+
+      uint8_t                             version = 0;
+      uint32_t                            next    = 0;   // index of the slot which receives the next sample
+      std::vector<powerup_history_sample> net;           // NET market samples
+      std::vector<powerup_history_sample> cpu;           // CPU market samples
+
+      uint64_t primary_key()const { return 0; }
+   };
+
+   typedef eosio::singleton<"powup.hist"_n, powerup_history> powerup_history_singleton;
+
    struct [[eosio::table("powup.order"),eosio::contract("eosio.system")]] powerup_order {
       uint8_t              version = 0;
       uint64_t             id;
@@ -631,6 +890,68 @@ namespace eosiosystem {
                                indexed_by<"byexpires"_n, const_mem_fun<powerup_order, uint64_t, &powerup_order::by_expires>>
                                > powerup_order_table;
 
+   // Powerup orders to the same owner which expire in the same second
+   struct powerup_bucket_entry {
+      name                 owner;
+      int64_t              net_weight;
+      int64_t              cpu_weight;
+   };
+
+   // All powerup orders paid by `payer` which expire at `expires`. Orders are added to buckets instead of
+   // `powup.order`; expiry processing consumes whole buckets in `expires` order. Each payer has its own
+   // buckets and is billed for their RAM, as it was for its `powup.order` rows.
+   struct [[eosio::table("powup.bucket"),eosio::contract("eosio.system")]] powerup_bucket {
+      uint8_t                           version = 0;
+      uint64_t                          id;
+      name                              payer;
+      time_point_sec                    expires;
+      std::vector<powerup_bucket_entry> orders;
+
+      uint64_t  primary_key()const { return id; }
+      uint128_t by_expires()const  { return (uint128_t(expires.utc_seconds) << 64) | payer.value; }
+   };
+
+   typedef eosio::multi_index< "powup.bucket"_n, powerup_bucket,
+                               indexed_by<"byexpires"_n, const_mem_fun<powerup_bucket, uint128_t, &powerup_bucket::by_expires>>
+                               > powerup_bucket_table;
+
+   // A standing powerup of `receiver` which `powerupexec` and `powerupexec2` renew from `balance` each
+   // time the previous period expires. While the market lacks the resources the renewal is retried by
+   // later passes. The subscription ends once a period can't be bought for at most `max_fee` or `balance`
+   // runs out: its fractions are zeroed and `expires` is set to the maximum time point, and the remaining
+   // balance stays held until `payer` withdraws it with `powupunsub` or resumes it with `powupsub`.
+   struct [[eosio::table("powup.sub"),eosio::contract("eosio.system")]] powerup_subscription {
+      uint8_t              version = 0;
+      name                 receiver;   // the resource receiver
+      name                 payer;      // the account funding the subscription
+      int64_t              net_frac;   // fraction of net (100% = 10^15) managed by the market
+      int64_t              cpu_frac;   // fraction of cpu (100% = 10^15) managed by the market
+      asset                max_fee;    // maximum fee paid for one period
+      asset                balance;    // prepaid tokens held by the system contract
+      time_point_sec       expires;    // end of the current period; the subscription is renewed after this
+
+      uint64_t primary_key()const { return receiver.value; }
+      uint64_t by_expires()const  { return expires.utc_seconds; }
+   };
+
+   typedef eosio::multi_index< "powup.sub"_n, powerup_subscription,
+                               indexed_by<"byexpires"_n, const_mem_fun<powerup_subscription, uint64_t, &powerup_subscription::by_expires>>
+                               > powerup_subscription_table;
+
+   // One receiver of a `powerupmany` batch
+   struct powerup_receiver {
+      name                 receiver;   // the resource receiver
+      int64_t              net_frac;   // fraction of net (100% = 10^15) managed by the market
+      int64_t              cpu_frac;   // fraction of cpu (100% = 10^15) managed by the market
+   };
+
+   // Fee and resources of a powerup, returned by `powerupquote`
+   struct powerup_quote {
+      asset                fee;             // powerup fee amount
+      int64_t              powup_net = 0;   // amount of powup NET tokens
+      int64_t              powup_cpu = 0;   // amount of powup CPU tokens
+   };
+
   /**
    * The `eosio.system` smart contract is provided by `block.one` as a sample system contract, and it defines the structures and actions needed for blockchain's core functionality.
    * 
@@ -647,6 +968,7 @@ namespace eosiosystem {
    class [[eosio::contract("eosio.system")]] system_contract : public native {
 
       private:
+         friend class native; // native::newaccount completes the accounts created by onboard
          voters_table             _voters;
          producers_table          _producers;
          producers_table2         _producers2;
@@ -664,7 +986,11 @@ namespace eosiosystem {
          rex_return_buckets_table _rexretbuckets;
          rex_fund_table           _rexfunds;
          rex_balance_table        _rexbalance;
+         rex_account_table        _rexaccounts;
          rex_order_table          _rexorders;
+         std::map<name, rex_account_cache> _rexaccounts_cache;
+         std::map<name, resource_limits_cache> _limits_cache;
+         bool                     _read_only = false; // set by read-only actions, nothing is written back on destruction
 
       public:
          static constexpr eosio::name active_permission{"active"_n};
@@ -762,6 +1088,27 @@ namespace eosiosystem {
          [[eosio::action]]
          void setacctcpu( const name& account, const std::optional<int64_t>& cpu_weight );
 
+         /**
+          * Set account limits in bulk action, which sets the RAM, NET and CPU limits of many accounts
+          * in one pass per account, with the same meaning as `setacctram`, `setacctnet` and `setacctcpu`.
+          * Unlike those actions, an empty field for a resource that is already unmanaged is not an error;
+          * that resource keeps its current limit, such as one set by `setalimits`.
+          *
+          * @param limits - the accounts with their RAM bytes, NET weight and CPU weight.
+          */
+         [[eosio::action]]
+         void setacctlims( const std::vector<account_limits>& limits );
+
+         /**
+          * Configure new accounts action, sets the options applied by `newaccount`.
+          *
+          * @param defer_userres - if true, `newaccount` does not create an empty `userres` row; the row is
+          *    created by the first `buyram`, `delegatebw`, REX loan or powerup for the account. Until then
+          *    the account has no `userres` row, as unlimited accounts have, which `setalimits` accepts.
+          */
+         [[eosio::action]]
+         void cfgnewacct( bool defer_userres );
+
 
          /**
           * The activate action, activates a protocol feature
@@ -790,6 +1137,20 @@ namespace eosiosystem {
          void delegatebw( const name& from, const name& receiver,
                           const asset& stake_net_quantity, const asset& stake_cpu_quantity, bool transfer );
 
+         /**
+          * Delegate bandwidth to many receivers action. Stakes SYS from the balance of `from` for the
+          * benefit of every receiver in `delegations`, as `delegatebw` without transfer would, but with
+          * a single token transfer and a single update of the voting power of `from`.
+          *
+          * @param from - the account to delegate bandwidth from,
+          * @param delegations - the receivers with the tokens staked for their NET and CPU bandwidth.
+          *
+          * @pre Receivers must be different than `from`.
+          * @post All producers `from` account has voted for will have their votes updated immediately.
+          */
+         [[eosio::action]]
+         void delegatebws( const name& from, const std::vector<bw_delegation>& delegations );
+
          /**
           * Setrex action, sets total_rent balance of REX pool to the passed value.
           * @param balance - amount to set the REX pool balance.
@@ -965,7 +1326,9 @@ namespace eosiosystem {
          void defnetloan( const name& from, uint64_t loan_num, const asset& amount );
 
          /**
-          * Updaterex action, updates REX owner vote weight to current value of held REX tokens.
+          * Updaterex action, updates REX owner vote stake to current value of held REX tokens.
+          * Producer and proxy votes of the owner are recalculated once the unsynced stake reaches
+          * 1/`rex_vote_sync_divisor` of owner stake, by `onblock`, `syncrexvotes` or the next vote update.
           *
           * @param owner - REX owner account.
           */
@@ -982,6 +1345,41 @@ namespace eosiosystem {
          [[eosio::action]]
          void rexexec( const name& user, uint16_t max );
 
+         /**
+          * Matchrex action, processes max CPU loans and max NET loans, then fills queued sellrex orders
+          * in one pass over the queue. The REX pool is updated once for all filled orders, and owners
+          * and proceeds of filled orders are reported together in a single `orderresults` action.
+          *
+          * @param user - any account can execute this action,
+          * @param max - number of each of CPU loans, NET loans, and sell orders to be processed.
+          */
+         [[eosio::action]]
+         void matchrex( const name& user, uint16_t max );
+
+         /**
+          * Rexexec2 action, processes expired CPU loans, expired NET loans and queued sellrex orders
+          * until `budget` work units are spent. Each loan costs `rex_loan_work_units` and each examined
+          * order `rex_order_work_units`. Progress is saved so that the next call resumes where this
+          * one stopped instead of starting over. Action does not execute anything related to a specific user.
+          *
+          * @param user - any account can execute this action,
+          * @param budget - number of work units to spend.
+          */
+         [[eosio::action]]
+         void rexexec2( const name& user, uint32_t budget );
+
+         /**
+          * Syncrexvotes action, brings REX vote stake of up to max voters queued by `updaterex` and
+          * `unstaketorex` up to date and recalculates their producer or proxy votes. Every `onblock`
+          * also processes `rex_vote_sync_per_block` queued voters.
+          * Action does not execute anything related to a specific user.
+          *
+          * @param user - any account can execute this action,
+          * @param max - number of queued voters to be processed.
+          */
+         [[eosio::action]]
+         void syncrexvotes( const name& user, uint16_t max );
+
          /**
           * Consolidate action, consolidates REX maturity buckets into one bucket that can be sold after 4 days
           * starting from the end of the day.
@@ -1027,6 +1425,18 @@ namespace eosiosystem {
          [[eosio::action]]
          void closerex( const name& owner );
 
+         /**
+          * Migraterex action, moves owner REX fund and REX balance entries into a single consolidated
+          * REX account entry. Any REX action which writes the owner's fund or balance does the same;
+          * this action migrates an account without changing it.
+          *
+          * @param owner - user account name.
+          *
+          * @pre Owner must have a REX fund or a REX balance entry and must not already be migrated.
+          */
+         [[eosio::action]]
+         void migraterex( const name& owner );
+
          /**
           * Undelegate bandwitdh action, decreases the total tokens delegated by `from` to `receiver` and/or
           * frees the memory associated with the delegation if there is nothing
@@ -1081,6 +1491,36 @@ namespace eosiosystem {
          [[eosio::action]]
          void buyrambytes( const name& payer, const name& receiver, uint32_t bytes );
 
+         /**
+          * Buy a specific amount of ram bytes for each of several receivers. Each purchase is priced
+          * as the `buyrambytes` action would price it right after the purchases before it, but the
+          * ram market is updated once and a single transfer is made for the ram and for the fee.
+          *
+          * @param payer - the ram buyer,
+          * @param purchases - the ram receivers and the quantity of ram each of them receives, in bytes.
+          */
+         [[eosio::action]]
+         void buyrambatch( const name& payer, const std::vector<ram_purchase>& purchases );
+
+         /**
+          * Onboard account action, creates `newact` with `ram_bytes` of ram bought by `creator` and
+          * the given stake delegated by `creator`. It has the same effect as `newaccount`, `buyrambytes`
+          * and `delegatebw` in one transaction, but the new account's resource rows and limits are
+          * written once, when `newaccount` creates the account.
+          *
+          * @param creator - the account creating `newact`, buying its ram and staking its bandwidth,
+          * @param newact - the name of the new account,
+          * @param owner - the owner authority of the new account,
+          * @param active - the active authority of the new account,
+          * @param ram_bytes - the quantity of ram to buy for the new account, in bytes,
+          * @param stake_net_quantity - tokens staked for NET bandwidth,
+          * @param stake_cpu_quantity - tokens staked for CPU bandwidth,
+          * @param transfer - if true, ownership of staked tokens is transfered to `newact`.
+          */
+         [[eosio::action]]
+         void onboard( const name& creator, const name& newact, const authority& owner, const authority& active,
+                       uint32_t ram_bytes, const asset& stake_net_quantity, const asset& stake_cpu_quantity, bool transfer );
+
          /**
           * Sell ram action, reduces quota by bytes and then performs an inline transfer of tokens
           * to receiver based upon the average purchase price of the original quota.
@@ -1091,6 +1531,19 @@ namespace eosiosystem {
          [[eosio::action]]
          void sellram( const name& account, int64_t bytes );
 
+         /**
+          * Transfer ram action, moves ram quota from one account to another at no cost. The ram
+          * market is not involved, so no fee is charged and no tokens are transferred. Neither account
+          * may have its ram managed by `setacctram`.
+          *
+          * @param from - the account giving up ram quota,
+          * @param to - the account receiving the ram quota,
+          * @param bytes - the amount of ram to transfer in bytes,
+          * @param memo - the memo string to accompany the transfer.
+          */
+         [[eosio::action]]
+         void ramtransfer( const name& from, const name& to, int64_t bytes, const std::string& memo );
+
          /**
           * Refund action, this action is called after the delegation-period to claim all pending
           * unstaked tokens belonging to owner.
@@ -1100,6 +1553,19 @@ namespace eosiosystem {
          [[eosio::action]]
          void refund( const name& owner );
 
+         /**
+          * Process refunds action, pays out the refunds of `owners` whose delegation-period has passed,
+          * exactly as `refund` does. Owners without a matured refund are skipped. Unstaked tokens are not
+          * returned automatically; either the owner calls `refund` or anyone calls this action. Matured
+          * refunds can be found through the `refundqueue` table; a caller leaves out any owner whose
+          * payout fails, so one owner can't hold back the refunds of others.
+          *
+          * @param user - any account can execute this action,
+          * @param owners - owners whose refunds are to be paid out.
+          */
+         [[eosio::action]]
+         void refundexec( const name& user, const std::vector<name>& owners );
+
          // functions defined in voting.cpp
 
          /**
@@ -1277,6 +1743,15 @@ namespace eosiosystem {
          [[eosio::action]]
          void bidrefund( const name& bidder, const name& newname );
 
+         /**
+          * Bid refunds action, pays the account `bidder` everything it is owed for being outbid,
+          * across all names, in a single transfer.
+          *
+          * @param bidder - the account that gets refunded.
+          */
+         [[eosio::action]]
+         void bidrefunds( const name& bidder );
+
          /**
           * Change the annual inflation rate of the core token supply and specify how
           * the new issued tokens will be distributed based on the following structure.
@@ -1304,7 +1779,8 @@ namespace eosiosystem {
          void cfgpowerup( powerup_config& args );
 
          /**
-          * Process power queue and update state. Action does not execute anything related to a specific user.
+          * Process power queue and update state, renewing due subscriptions. Action does not execute anything
+          * related to a specific user.
           *
           * @param user - any account can execute this action
           * @param max - number of queue items to process
@@ -1312,6 +1788,17 @@ namespace eosiosystem {
          [[eosio::action]]
          void powerupexec( const name& user, uint16_t max );
 
+         /**
+          * Process power queue and update state, expiring orders until `budget` work units are spent.
+          * Each expired order costs `powerup_order_work_units`. Action does not execute anything related
+          * to a specific user.
+          *
+          * @param user - any account can execute this action
+          * @param budget - number of work units to spend
+          */
+         [[eosio::action]]
+         void powerupexec2( const name& user, uint32_t budget );
+
          /**
           * Powerup NET and CPU resources by percentage
           *
@@ -1326,6 +1813,63 @@ namespace eosiosystem {
          [[eosio::action]]
          void powerup( const name& payer, const name& receiver, uint32_t days, int64_t net_frac, int64_t cpu_frac, const asset& max_payment );
 
+         /**
+          * Powerup NET and CPU resources by percentage for several receivers. The market state is updated,
+          * the fee is charged and `powupresult` is sent once for the whole batch.
+          *
+          * @param payer - the resource buyer
+          * @param receivers - the resource receivers with the fractions of net and cpu each of them receives.
+          *    Fees of each receiver must reach the minimum powerup fee.
+          * @param days - number of days of resource availability. Must match market configuration.
+          * @param max_payment - the maximum amount `payer` is willing to pay for all receivers. Tokens are
+          *    withdrawn from `payer`'s token balance.
+          */
+         [[eosio::action]]
+         void powerupmany( const name& payer, const std::vector<powerup_receiver>& receivers, uint32_t days, const asset& max_payment );
+
+         /**
+          * Quote the fee of a `powerup` against the current market state without changing it. Expired orders which
+          * `powerup` would process first are taken into account, so `fee` is exactly what `powerup` would charge
+          * within the same block. The action is read-only: it writes no table, including the global state.
+          *
+          * @param days - number of days of resource availability. Must match market configuration.
+          * @param net_frac - fraction of net (100% = 10^15) managed by this market
+          * @param cpu_frac - fraction of cpu (100% = 10^15) managed by this market
+          *
+          * @return powerup_quote - the fee and the amounts of NET and CPU weight
+          */
+         [[eosio::action, eosio::read_only]]
+         powerup_quote powerupquote( uint32_t days, int64_t net_frac, int64_t cpu_frac );
+
+         /**
+          * Subscribe `receiver` to a standing powerup paid by `payer`, or update an existing subscription.
+          * `powerupexec` and `powerupexec2` buy a new period for `receiver` once the previous one expires,
+          * so the released and the renewed resources are applied together. The first period is bought by
+          * the next of these actions; a period the market can't supply is retried by the following ones.
+          * Updating a subscription which has ended resumes it.
+          *
+          * @param payer - the account funding the subscription
+          * @param receiver - the resource receiver
+          * @param net_frac - fraction of net (100% = 10^15) managed by this market, bought each period
+          * @param cpu_frac - fraction of cpu (100% = 10^15) managed by this market, bought each period
+          * @param max_fee - the maximum fee `payer` is willing to pay for one period
+          * @param deposit - tokens moved from `payer`'s token balance to the subscription balance
+          */
+         [[eosio::action]]
+         void powupsub( const name& payer, const name& receiver, int64_t net_frac, int64_t cpu_frac, const asset& max_fee,
+                        const asset& deposit );
+
+         /**
+          * Cancel the subscription of `receiver` and return its remaining balance to `payer`. The current
+          * period stays in effect until it expires. This is also how `payer` withdraws the balance of a
+          * subscription which has ended.
+          *
+          * @param payer - the account funding the subscription
+          * @param receiver - the resource receiver
+          */
+         [[eosio::action]]
+         void powupunsub( const name& payer, const name& receiver );
+
          /**
           * Configure voter pools. Pools become available the first time this action is invoked.
           *
@@ -1492,8 +2036,11 @@ namespace eosiosystem {
          using setacctram_action = eosio::action_wrapper<"setacctram"_n, &system_contract::setacctram>;
          using setacctnet_action = eosio::action_wrapper<"setacctnet"_n, &system_contract::setacctnet>;
          using setacctcpu_action = eosio::action_wrapper<"setacctcpu"_n, &system_contract::setacctcpu>;
+         using setacctlims_action = eosio::action_wrapper<"setacctlims"_n, &system_contract::setacctlims>;
+         using cfgnewacct_action = eosio::action_wrapper<"cfgnewacct"_n, &system_contract::cfgnewacct>;
          using activate_action = eosio::action_wrapper<"activate"_n, &system_contract::activate>;
          using delegatebw_action = eosio::action_wrapper<"delegatebw"_n, &system_contract::delegatebw>;
+         using delegatebws_action = eosio::action_wrapper<"delegatebws"_n, &system_contract::delegatebws>;
          using deposit_action = eosio::action_wrapper<"deposit"_n, &system_contract::deposit>;
          using withdraw_action = eosio::action_wrapper<"withdraw"_n, &system_contract::withdraw>;
          using buyrex_action = eosio::action_wrapper<"buyrex"_n, &system_contract::buyrex>;
@@ -1508,16 +2055,24 @@ namespace eosiosystem {
          using defnetloan_action = eosio::action_wrapper<"defnetloan"_n, &system_contract::defnetloan>;
          using updaterex_action = eosio::action_wrapper<"updaterex"_n, &system_contract::updaterex>;
          using rexexec_action = eosio::action_wrapper<"rexexec"_n, &system_contract::rexexec>;
+         using matchrex_action = eosio::action_wrapper<"matchrex"_n, &system_contract::matchrex>;
+         using rexexec2_action = eosio::action_wrapper<"rexexec2"_n, &system_contract::rexexec2>;
+         using syncrexvotes_action = eosio::action_wrapper<"syncrexvotes"_n, &system_contract::syncrexvotes>;
          using setrex_action = eosio::action_wrapper<"setrex"_n, &system_contract::setrex>;
          using mvtosavings_action = eosio::action_wrapper<"mvtosavings"_n, &system_contract::mvtosavings>;
          using mvfrsavings_action = eosio::action_wrapper<"mvfrsavings"_n, &system_contract::mvfrsavings>;
          using consolidate_action = eosio::action_wrapper<"consolidate"_n, &system_contract::consolidate>;
          using closerex_action = eosio::action_wrapper<"closerex"_n, &system_contract::closerex>;
+         using migraterex_action = eosio::action_wrapper<"migraterex"_n, &system_contract::migraterex>;
          using undelegatebw_action = eosio::action_wrapper<"undelegatebw"_n, &system_contract::undelegatebw>;
          using buyram_action = eosio::action_wrapper<"buyram"_n, &system_contract::buyram>;
          using buyrambytes_action = eosio::action_wrapper<"buyrambytes"_n, &system_contract::buyrambytes>;
+         using buyrambatch_action = eosio::action_wrapper<"buyrambatch"_n, &system_contract::buyrambatch>;
+         using onboard_action = eosio::action_wrapper<"onboard"_n, &system_contract::onboard>;
          using sellram_action = eosio::action_wrapper<"sellram"_n, &system_contract::sellram>;
+         using ramtransfer_action = eosio::action_wrapper<"ramtransfer"_n, &system_contract::ramtransfer>;
          using refund_action = eosio::action_wrapper<"refund"_n, &system_contract::refund>;
+         using refundexec_action = eosio::action_wrapper<"refundexec"_n, &system_contract::refundexec>;
          using regproducer_action = eosio::action_wrapper<"regproducer"_n, &system_contract::regproducer>;
          using regproducer2_action = eosio::action_wrapper<"regproducer2"_n, &system_contract::regproducer2>;
          using unregprod_action = eosio::action_wrapper<"unregprod"_n, &system_contract::unregprod>;
@@ -1530,6 +2085,7 @@ namespace eosiosystem {
          using updtrevision_action = eosio::action_wrapper<"updtrevision"_n, &system_contract::updtrevision>;
          using bidname_action = eosio::action_wrapper<"bidname"_n, &system_contract::bidname>;
          using bidrefund_action = eosio::action_wrapper<"bidrefund"_n, &system_contract::bidrefund>;
+         using bidrefunds_action = eosio::action_wrapper<"bidrefunds"_n, &system_contract::bidrefunds>;
          using setpriv_action = eosio::action_wrapper<"setpriv"_n, &system_contract::setpriv>;
          using setalimits_action = eosio::action_wrapper<"setalimits"_n, &system_contract::setalimits>;
          using setparams_action = eosio::action_wrapper<"setparams"_n, &system_contract::setparams>;
@@ -1537,7 +2093,12 @@ namespace eosiosystem {
          using setinflation_action = eosio::action_wrapper<"setinflation"_n, &system_contract::setinflation>;
          using cfgpowerup_action = eosio::action_wrapper<"cfgpowerup"_n, &system_contract::cfgpowerup>;
          using powerupexec_action = eosio::action_wrapper<"powerupexec"_n, &system_contract::powerupexec>;
+         using powerupexec2_action = eosio::action_wrapper<"powerupexec2"_n, &system_contract::powerupexec2>;
          using powerup_action = eosio::action_wrapper<"powerup"_n, &system_contract::powerup>;
+         using powerupmany_action = eosio::action_wrapper<"powerupmany"_n, &system_contract::powerupmany>;
+         using powerupquote_action = eosio::action_wrapper<"powerupquote"_n, &system_contract::powerupquote>;
+         using powupsub_action = eosio::action_wrapper<"powupsub"_n, &system_contract::powupsub>;
+         using powupunsub_action = eosio::action_wrapper<"powupunsub"_n, &system_contract::powupunsub>;
          using cfgsrpool_action = eosio::action_wrapper<"cfgsrpool"_n, &system_contract::cfgsrpool>;
          using stake2pool_action = eosio::action_wrapper<"stake2pool"_n, &system_contract::stake2pool>;
          using setpoolnotif_action = eosio::action_wrapper<"setpoolnotif"_n, &system_contract::setpoolnotif>;
@@ -1564,15 +2125,31 @@ namespace eosiosystem {
          static eosio_global_state4 get_default_inflation_parameters();
          symbol core_symbol()const;
          void update_ram_supply();
+         void update_ram_price_accumulator();
+         void get_account_limits( const name& account, int64_t& ram_bytes, int64_t& net_weight, int64_t& cpu_weight );
+         void set_account_limits( const name& account, int64_t ram_bytes, int64_t net_weight, int64_t cpu_weight );
+         void flush_account_limits();
 
          // defined in rex.cpp
          void runrex( uint16_t max );
+         void begin_rex_maintenance();
          void update_rex_pool();
          void update_resource_limits( const name& from, const name& receiver, int64_t delta_net, int64_t delta_cpu );
          void check_voting_requirement( const name& owner,
                                         const char* error_msg = "must vote for at least 21 producers or for a proxy before buying REX" )const;
-         rex_order_outcome fill_rex_order( const rex_balance_table::const_iterator& bitr, const asset& rex );
-         asset update_rex_account( const name& owner, const asset& proceeds, const asset& unstake_quant, bool force_vote_update = false );
+         rex_order_outcome fill_rex_order( rex_account_cache& racct, const asset& rex );
+         rex_order_outcome fill_rex_order( rex_account_cache& racct, const asset& rex,
+                                           int64_t& total_rex, int64_t& total_lendable, int64_t total_lent );
+         std::vector<std::pair<name, asset>> fill_rex_orders( uint16_t max );
+         std::vector<std::pair<name, asset>> fill_rex_orders( uint32_t max, uint64_t& order_time, uint32_t& examined );
+         void process_expired_rex_loans( uint16_t max );
+         template <typename T>
+         uint32_t process_expired_loans( bool cpu, uint32_t max );
+         template <typename Index, typename Iterator>
+         std::pair<bool, int64_t> process_expired_loan( Index& idx, const Iterator& itr );
+         asset update_rex_account( const name& owner, const asset& proceeds, const asset& unstake_quant, bool lazy_vote_update = false );
+         void update_rex_vote_stake( const name& owner, const asset& delta_stake );
+         void sync_rex_votes( uint16_t max );
          void channel_to_rex( const name& from, const asset& amount );
          void channel_namebid_to_rex( const int64_t highest_bid );
          template <typename T>
@@ -1590,12 +2167,12 @@ namespace eosiosystem {
          asset add_to_rex_balance( const name& owner, const asset& payment, const asset& rex_received );
          asset add_to_rex_pool( const asset& payment );
          void add_to_rex_return_pool( const asset& fee );
-         void process_rex_maturities( const rex_balance_table::const_iterator& bitr );
-         void consolidate_rex_balance( const rex_balance_table::const_iterator& bitr,
-                                       const asset& rex_in_sell_order );
-         int64_t read_rex_savings( const rex_balance_table::const_iterator& bitr );
-         void put_rex_savings( const rex_balance_table::const_iterator& bitr, int64_t rex );
+         void process_rex_maturities( rex_account_cache& racct );
+         void consolidate_rex_balance( rex_account_cache& racct, const asset& rex_in_sell_order );
+         void add_maturing_rex( rex_account_cache& racct, int64_t rex );
          void update_rex_stake( const name& voter );
+         rex_account_cache& get_rex_account( const name& owner );
+         void flush_rex_accounts();
 
          void add_loan_to_rex_pool( const asset& payment, int64_t rented_tokens, bool new_loan );
          void remove_loan_from_rex_pool( const rex_loan& loan );
@@ -1605,7 +2182,16 @@ namespace eosiosystem {
          // defined in delegate_bandwidth.cpp
          void changebw( name from, const name& receiver,
                         const asset& stake_net_quantity, const asset& stake_cpu_quantity, bool transfer );
-         void update_voting_power( const name& voter, const asset& total_update );
+         void update_delegation( const name& from, const name& receiver,
+                                 const asset& stake_net_delta, const asset& stake_cpu_delta );
+         void update_delegator_index( const name& from, const name& receiver, bool delegating );
+         void add_ram_bytes( const name& receiver, int64_t bytes_out );
+         void update_refund_queue( const name& owner, const refund_request* req );
+         void update_voting_power( const name& voter, const asset& total_update, bool recalc_votes = true );
+
+         // defined in name_bidding.cpp
+         void rank_name_bid( const name_bid& bid );
+         name_bid_leaderboard refresh_name_bid_leaderboard();
 
          // defined in voting.cpp
          void register_producer( const name& producer, const eosio::block_signing_authority& producer_authority, const std::string& url, uint16_t location );
@@ -1655,7 +2241,14 @@ namespace eosiosystem {
          void process_powerup_queue(
             time_point_sec now, symbol core_symbol, powerup_state& state,
             powerup_order_table& orders, uint32_t max_items, int64_t& net_delta_available,
-            int64_t& cpu_delta_available);
+            int64_t& cpu_delta_available, bool dry_run = false, bool renew_subscriptions = false);
+         void add_powerup_order(time_point_sec expires, name payer, name owner, int64_t net_weight, int64_t cpu_weight);
+         void record_powerup_history(time_point_sec now, powerup_state& state);
+         void renew_powerup_subscriptions(time_point_sec now, symbol core_symbol, powerup_state& state, uint32_t max_items,
+                                          int64_t& net_delta_available, int64_t& cpu_delta_available,
+                                          std::map<name, std::pair<int64_t, int64_t>>& owner_deltas);
+         void powerup_receivers(const name& payer, const std::vector<powerup_receiver>& receivers, uint32_t days,
+                                const asset& max_payment);
 
          struct staking_pool_state_autosave {
             system_contract& contract;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <eosio/action.hpp>
+#include <eosio/binary_extension.hpp>
 #include <eosio/contract.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/fixed_bytes.hpp>
@@ -108,13 +109,15 @@ namespace eosiosystem {
     * abi_hash is the structure underlying the abihash table and consists of:
     * - `owner`: the account owner of the contract's abi
     * - `hash`: is the sha256 hash of the abi/binary
+    * - `size`: is the size in bytes of the abi/binary, missing in rows not written since it was added
     */
    struct [[eosio::table("abihash"), eosio::contract("eosio.system")]] abi_hash {
-      name              owner;
-      checksum256       hash;
+      name                              owner;
+      checksum256                       hash;
+      eosio::binary_extension<uint32_t> size;
       uint64_t primary_key()const { return owner.value; }
 
-      EOSLIB_SERIALIZE( abi_hash, (owner)(hash) )
+      EOSLIB_SERIALIZE( abi_hash, (owner)(hash)(size) )
    };
 
    // Method parameters commented out to prevent generation of code that parses input data.
@@ -9,8 +9,8 @@ using eosio::asset;
 using eosio::name;
 
 /**
- * The actions `buyresult`, `sellresult`, `rentresult`, and `orderresult` of `rex.results` are all no-ops.
- * They are added as inline convenience actions to `rentnet`, `rentcpu`, `buyrex`, `unstaketorex`, and `sellrex`.
+ * The actions `buyresult`, `sellresult`, `rentresult`, `orderresult`, and `orderresults` of `rex.results` are all no-ops.
+ * They are added as inline convenience actions to `rentnet`, `rentcpu`, `buyrex`, `unstaketorex`, `sellrex`, and `matchrex`.
  * An inline convenience action does not have any effect, however,
  * its data includes the result of the parent action and appears in its trace.
  */
@@ -44,6 +44,14 @@ class [[eosio::contract("rex.results")]] rex_results : eosio::contract {
       [[eosio::action]]
       void orderresult( const name& owner, const asset& proceeds );
 
+      /**
+       * Orderresults action.
+       *
+       * @param fills - owner and proceeds of each order filled in one pass
+       */
+      [[eosio::action]]
+      void orderresults( const std::vector<std::pair<name, asset>>& fills );
+
       /**
        * Rentresult action.
        *
@@ -52,8 +60,9 @@ class [[eosio::contract("rex.results")]] rex_results : eosio::contract {
       [[eosio::action]]
       void rentresult( const asset& rented_tokens );
 
-      using buyresult_action   = action_wrapper<"buyresult"_n,   &rex_results::buyresult>;
-      using sellresult_action  = action_wrapper<"sellresult"_n,  &rex_results::sellresult>;
-      using orderresult_action = action_wrapper<"orderresult"_n, &rex_results::orderresult>;
-      using rentresult_action  = action_wrapper<"rentresult"_n,  &rex_results::rentresult>;
+      using buyresult_action    = action_wrapper<"buyresult"_n,    &rex_results::buyresult>;
+      using sellresult_action   = action_wrapper<"sellresult"_n,   &rex_results::sellresult>;
+      using orderresult_action  = action_wrapper<"orderresult"_n,  &rex_results::orderresult>;
+      using orderresults_action = action_wrapper<"orderresults"_n, &rex_results::orderresults>;
+      using rentresult_action   = action_wrapper<"rentresult"_n,   &rex_results::rentresult>;
 };
@@ -79,6 +79,143 @@ namespace eosiosystem {
       _gstate.total_ram_bytes_reserved += uint64_t(bytes_out);
       _gstate.total_ram_stake          += quant_after_fee.amount;
 
+      add_ram_bytes( receiver, bytes_out );
+   }
+
+   /**
+    *  Prices a purchase of `bytes` of ram the way buyrambytes and buyram price it and converts it in
+    *  `market`. Returns the bytes bought and sets the tokens added to the market and the fee.
+    */
+   int64_t convert_ram_purchase( exchange_state& market, uint32_t bytes, const symbol& core,
+                                 int64_t& quant_after_fee, int64_t& fee ) {
+      const int64_t cost          = exchange_state::get_bancor_input( market.base.balance.amount, market.quote.balance.amount, bytes );
+      const int64_t cost_plus_fee = cost / double(0.995);
+      check( cost_plus_fee > 0, "must purchase a positive amount" );
+      fee             = ( cost_plus_fee + 199 ) / 200; /// .5% fee (round up)
+      quant_after_fee = cost_plus_fee - fee;
+      const int64_t bytes_out = market.direct_convert( asset{ quant_after_fee, core }, ram_symbol ).amount;
+      check( bytes_out > 0, "must reserve a positive amount" );
+      return bytes_out;
+   }
+
+   /**
+    *  Purchases are priced one after the other against a copy of the ram market, exactly as a
+    *  sequence of buyrambytes actions would price them, so each receiver gets the same amount of
+    *  ram and the payer pays the same total. The market row and the token balances are then
+    *  written once for the whole batch.
+    */
+   void system_contract::buyrambatch( const name& payer, const std::vector<ram_purchase>& purchases )
+   {
+      require_auth( payer );
+      update_ram_supply();
+
+      check( !purchases.empty(), "purchases can't be empty" );
+
+      const auto& market = _rammarket.get(ramcore_symbol.raw(), "ram market does not exist");
+      exchange_state priced = market;
+
+      int64_t quant_after_fee = 0;
+      int64_t fee             = 0;
+      std::vector<int64_t> bytes_out;
+      bytes_out.reserve( purchases.size() );
+      for( const auto& p : purchases ) {
+         int64_t item_quant, item_fee;
+         bytes_out.push_back( convert_ram_purchase( priced, p.bytes, core_symbol(), item_quant, item_fee ) );
+         quant_after_fee += item_quant;
+         fee             += item_fee;
+      }
+
+      {
+         token::transfer_action transfer_act{ token_account, { {payer, active_permission}, {ram_account, active_permission} } };
+         transfer_act.send( payer, ram_account, asset{ quant_after_fee, core_symbol() }, "buy ram" );
+      }
+      if ( fee > 0 ) {
+         token::transfer_action transfer_act{ token_account, { {payer, active_permission} } };
+         transfer_act.send( payer, ramfee_account, asset{ fee, core_symbol() }, "ram fee" );
+         channel_to_rex_or_pools( ramfee_account, asset{ fee, core_symbol() }, false );
+      }
+
+      _rammarket.modify( market, same_payer, [&]( auto& es ) {
+         es = priced;
+      });
+
+      for( size_t i = 0; i < purchases.size(); ++i ) {
+         _gstate.total_ram_bytes_reserved += uint64_t(bytes_out[i]);
+         add_ram_bytes( purchases[i].receiver, bytes_out[i] );
+      }
+      _gstate.total_ram_stake += quant_after_fee;
+   }
+
+   /**
+    *  Tokens move and the ram market, the global totals and the creator's records are updated here.
+    *  The rows of the new account are written by the newaccount handler from the pending onboarding
+    *  row, together with the account's only set_resource_limits call.
+    */
+   void system_contract::onboard( const name& creator, const name& newact, const authority& owner, const authority& active,
+                                  uint32_t ram_bytes, const asset& stake_net_quantity, const asset& stake_cpu_quantity, bool transfer )
+   {
+      require_auth( creator );
+      check( !is_account( newact ), "account already exists" );
+
+      asset zero_asset( 0, core_symbol() );
+      check( stake_net_quantity.symbol == core_symbol() && stake_cpu_quantity.symbol == core_symbol(), "must stake core token" );
+      check( stake_cpu_quantity >= zero_asset, "must stake a positive amount" );
+      check( stake_net_quantity >= zero_asset, "must stake a positive amount" );
+
+      int64_t bytes_out = 0;
+      if( ram_bytes > 0 ) {
+         update_ram_supply();
+         const auto& market = _rammarket.get(ramcore_symbol.raw(), "ram market does not exist");
+         int64_t quant_after_fee, fee;
+         _rammarket.modify( market, same_payer, [&]( auto& es ) {
+            bytes_out = convert_ram_purchase( es, ram_bytes, core_symbol(), quant_after_fee, fee );
+         });
+         _gstate.total_ram_bytes_reserved += uint64_t(bytes_out);
+         _gstate.total_ram_stake          += quant_after_fee;
+
+         {
+            token::transfer_action transfer_act{ token_account, { {creator, active_permission}, {ram_account, active_permission} } };
+            transfer_act.send( creator, ram_account, asset{ quant_after_fee, core_symbol() }, "buy ram" );
+         }
+         if ( fee > 0 ) {
+            token::transfer_action transfer_act{ token_account, { {creator, active_permission} } };
+            transfer_act.send( creator, ramfee_account, asset{ fee, core_symbol() }, "ram fee" );
+            channel_to_rex_or_pools( ramfee_account, asset{ fee, core_symbol() }, false );
+         }
+      }
+
+      const asset stake = stake_net_quantity + stake_cpu_quantity;
+      if( stake.amount > 0 ) {
+         if( !transfer ) {
+            del_bandwidth_table del_tbl( get_self(), creator.value );
+            del_tbl.emplace( creator, [&]( auto& dbo ){
+               dbo.from          = creator;
+               dbo.to            = newact;
+               dbo.net_weight    = stake_net_quantity;
+               dbo.cpu_weight    = stake_cpu_quantity;
+            });
+            update_delegator_index( creator, newact, true );
+            vote_stake_updater( creator );
+            update_voting_power( creator, stake );
+         }
+         token::transfer_action transfer_act{ token_account, { {creator, active_permission} } };
+         transfer_act.send( creator, stake_account, stake, "stake bandwidth" );
+      }
+
+      pending_onboarding_table onboarding( get_self(), get_self().value );
+      onboarding.emplace( creator, [&]( auto& ob ) {
+         ob.account    = newact;
+         ob.ram_bytes  = bytes_out;
+         ob.net_weight = stake_net_quantity;
+         ob.cpu_weight = stake_cpu_quantity;
+         ob.transfer   = transfer;
+      });
+
+      eosio::action( permission_level{ creator, active_permission }, get_self(), "newaccount"_n,
+                     std::make_tuple( creator, newact, owner, active ) ).send();
+   }
+
+   void system_contract::add_ram_bytes( const name& receiver, int64_t bytes_out ) {
       user_resources_table  userres( get_self(), receiver.value );
       auto res_itr = userres.find( receiver.value );
       if( res_itr ==  userres.end() ) {
@@ -97,8 +234,8 @@ namespace eosiosystem {
       auto voter_itr = _voters.find( res_itr->owner.value );
       if( voter_itr == _voters.end() || !has_field( voter_itr->flags1, voter_info::flags1_fields::ram_managed ) ) {
          int64_t ram_bytes, net, cpu;
-         get_resource_limits( res_itr->owner, ram_bytes, net, cpu );
-         set_resource_limits( res_itr->owner, res_itr->ram_bytes + ram_gift_bytes, net, cpu );
+         get_account_limits( res_itr->owner, ram_bytes, net, cpu );
+         set_account_limits( res_itr->owner, res_itr->ram_bytes + ram_gift_bytes, net, cpu );
       }
    }
 
@@ -141,8 +278,8 @@ namespace eosiosystem {
       auto voter_itr = _voters.find( res_itr->owner.value );
       if( voter_itr == _voters.end() || !has_field( voter_itr->flags1, voter_info::flags1_fields::ram_managed ) ) {
          int64_t ram_bytes, net, cpu;
-         get_resource_limits( res_itr->owner, ram_bytes, net, cpu );
-         set_resource_limits( res_itr->owner, res_itr->ram_bytes + ram_gift_bytes, net, cpu );
+         get_account_limits( res_itr->owner, ram_bytes, net, cpu );
+         set_account_limits( res_itr->owner, res_itr->ram_bytes + ram_gift_bytes, net, cpu );
       }
 
       {
@@ -158,6 +295,42 @@ namespace eosiosystem {
       }
    }
 
+   /**
+    *  Ram quota moves between userres rows directly. The tokens backing it stay in eosio.ram and
+    *  total_ram_bytes_reserved is unchanged, so the ram market is not touched.
+    */
+   void system_contract::ramtransfer( const name& from, const name& to, int64_t bytes, const std::string& memo ) {
+      require_auth( from );
+
+      check( bytes > 0, "must transfer positive bytes" );
+      check( from != to, "cannot transfer to self" );
+      check( is_account( to ), "to account does not exist" );
+      check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+      // the ram limit of a managed account is set by setacctram and is not backed by its quota
+      auto is_ram_managed = [&]( const name& account ) {
+         auto voter_itr = _voters.find( account.value );
+         return voter_itr != _voters.end() && has_field( voter_itr->flags1, voter_info::flags1_fields::ram_managed );
+      };
+      check( !is_ram_managed( from ), "cannot transfer from an account with managed ram" );
+      check( !is_ram_managed( to ), "cannot transfer to an account with managed ram" );
+
+      user_resources_table  userres( get_self(), from.value );
+      auto res_itr = userres.find( from.value );
+      check( res_itr != userres.end(), "no resource row" );
+      check( res_itr->ram_bytes >= bytes, "insufficient quota" );
+
+      userres.modify( res_itr, from, [&]( auto& res ) {
+          res.ram_bytes -= bytes;
+      });
+
+      int64_t ram_bytes, net, cpu;
+      get_account_limits( from, ram_bytes, net, cpu );
+      set_account_limits( from, res_itr->ram_bytes + ram_gift_bytes, net, cpu );
+
+      add_ram_bytes( to, bytes );
+   }
+
    void validate_b1_vesting( int64_t stake ) {
       const int64_t base_time = 1527811200; /// 2018-06-01
       const int64_t max_claimable = 100'000'000'0000ll;
@@ -180,77 +353,7 @@ namespace eosiosystem {
          from = receiver;
       }
 
-      // update stake delegated from "from" to "receiver"
-      {
-         del_bandwidth_table     del_tbl( get_self(), from.value );
-         auto itr = del_tbl.find( receiver.value );
-         if( itr == del_tbl.end() ) {
-            itr = del_tbl.emplace( from, [&]( auto& dbo ){
-                  dbo.from          = from;
-                  dbo.to            = receiver;
-                  dbo.net_weight    = stake_net_delta;
-                  dbo.cpu_weight    = stake_cpu_delta;
-               });
-         }
-         else {
-            del_tbl.modify( itr, same_payer, [&]( auto& dbo ){
-                  dbo.net_weight    += stake_net_delta;
-                  dbo.cpu_weight    += stake_cpu_delta;
-               });
-         }
-         check( 0 <= itr->net_weight.amount, "insufficient staked net bandwidth" );
-         check( 0 <= itr->cpu_weight.amount, "insufficient staked cpu bandwidth" );
-         if ( itr->is_empty() ) {
-            del_tbl.erase( itr );
-         }
-      } // itr can be invalid, should go out of scope
-
-      // update totals of "receiver"
-      {
-         user_resources_table   totals_tbl( get_self(), receiver.value );
-         auto tot_itr = totals_tbl.find( receiver.value );
-         if( tot_itr ==  totals_tbl.end() ) {
-            tot_itr = totals_tbl.emplace( from, [&]( auto& tot ) {
-                  tot.owner = receiver;
-                  tot.net_weight    = stake_net_delta;
-                  tot.cpu_weight    = stake_cpu_delta;
-               });
-         } else {
-            totals_tbl.modify( tot_itr, from == receiver ? from : same_payer, [&]( auto& tot ) {
-                  tot.net_weight    += stake_net_delta;
-                  tot.cpu_weight    += stake_cpu_delta;
-               });
-         }
-         check( 0 <= tot_itr->net_weight.amount, "insufficient staked total net bandwidth" );
-         check( 0 <= tot_itr->cpu_weight.amount, "insufficient staked total cpu bandwidth" );
-
-         {
-            bool ram_managed = false;
-            bool net_managed = false;
-            bool cpu_managed = false;
-
-            auto voter_itr = _voters.find( receiver.value );
-            if( voter_itr != _voters.end() ) {
-               ram_managed = has_field( voter_itr->flags1, voter_info::flags1_fields::ram_managed );
-               net_managed = has_field( voter_itr->flags1, voter_info::flags1_fields::net_managed );
-               cpu_managed = has_field( voter_itr->flags1, voter_info::flags1_fields::cpu_managed );
-            }
-
-            if( !(net_managed && cpu_managed) ) {
-               int64_t ram_bytes, net, cpu;
-               get_resource_limits( receiver, ram_bytes, net, cpu );
-
-               set_resource_limits( receiver,
-                                    ram_managed ? ram_bytes : std::max( tot_itr->ram_bytes + ram_gift_bytes, ram_bytes ),
-                                    net_managed ? net : tot_itr->net_weight.amount,
-                                    cpu_managed ? cpu : tot_itr->cpu_weight.amount );
-            }
-         }
-
-         if ( tot_itr->is_empty() ) {
-            totals_tbl.erase( tot_itr );
-         }
-      } // tot_itr can be invalid, should go out of scope
+      update_delegation( from, receiver, stake_net_delta, stake_cpu_delta );
 
       // create refund or update from existing refund
       if ( stake_account != source_stake_from ) { //for eosio both transfer and refund make no sense
@@ -260,8 +363,6 @@ namespace eosiosystem {
          //create/update/delete refund
          auto net_balance = stake_net_delta;
          auto cpu_balance = stake_cpu_delta;
-         bool need_deferred_trx = false;
-
 
          // net and cpu are same sign by assertions in delegatebw and undelegatebw
          // redundant assertion also at start of changebw to protect against misuse of changebw
@@ -295,12 +396,12 @@ namespace eosiosystem {
 
                if ( req->is_empty() ) {
                   refunds_tbl.erase( req );
-                  need_deferred_trx = false;
+                  update_refund_queue( from, nullptr );
                } else {
-                  need_deferred_trx = true;
+                  update_refund_queue( from, &*req );
                }
             } else if ( net_balance.amount < 0 || cpu_balance.amount < 0 ) { //need to create refund
-               refunds_tbl.emplace( from, [&]( refund_request& r ) {
+               req = refunds_tbl.emplace( from, [&]( refund_request& r ) {
                   r.owner = from;
                   if ( net_balance.amount < 0 ) {
                      r.net_amount = -net_balance;
@@ -316,23 +417,10 @@ namespace eosiosystem {
                   }
                   r.request_time = current_time_point();
                });
-               need_deferred_trx = true;
+               update_refund_queue( from, &*req );
             } // else stake increase requested with no existing row in refunds_tbl -> nothing to do with refunds_tbl
          } /// end if is_delegating_to_self || is_undelegating
 
-         if ( need_deferred_trx ) {
-            eosio::transaction out;
-            out.actions.emplace_back( permission_level{from, active_permission},
-                                      get_self(), "refund"_n,
-                                      from
-            );
-            out.delay_sec = refund_delay_sec;
-            eosio::cancel_deferred( from.value ); // TODO: Remove this line when replacing deferred trxs is fixed
-            out.send( from.value, from, true );
-         } else {
-            eosio::cancel_deferred( from.value );
-         }
-
          auto transfer_amount = net_balance + cpu_balance;
          if ( 0 < transfer_amount.amount ) {
             token::transfer_action transfer_act{ token_account, { {source_stake_from, active_permission} } };
@@ -344,7 +432,108 @@ namespace eosiosystem {
       update_voting_power( from, stake_net_delta + stake_cpu_delta );
    }
 
-   void system_contract::update_voting_power( const name& voter, const asset& total_update )
+   /**
+    *  Applies a stake delta to the `delband` row of `from` towards `receiver` and to the
+    *  `userres` totals and resource limits of `receiver`.
+    */
+   void system_contract::update_delegation( const name& from, const name& receiver,
+                                            const asset& stake_net_delta, const asset& stake_cpu_delta )
+   {
+      // update stake delegated from "from" to "receiver"
+      {
+         del_bandwidth_table     del_tbl( get_self(), from.value );
+         auto itr = del_tbl.find( receiver.value );
+         if( itr == del_tbl.end() ) {
+            itr = del_tbl.emplace( from, [&]( auto& dbo ){
+                  dbo.from          = from;
+                  dbo.to            = receiver;
+                  dbo.net_weight    = stake_net_delta;
+                  dbo.cpu_weight    = stake_cpu_delta;
+               });
+         }
+         else {
+            del_tbl.modify( itr, same_payer, [&]( auto& dbo ){
+                  dbo.net_weight    += stake_net_delta;
+                  dbo.cpu_weight    += stake_cpu_delta;
+               });
+         }
+         check( 0 <= itr->net_weight.amount, "insufficient staked net bandwidth" );
+         check( 0 <= itr->cpu_weight.amount, "insufficient staked cpu bandwidth" );
+         const bool delegating = !itr->is_empty();
+         if ( !delegating ) {
+            del_tbl.erase( itr );
+         }
+         if ( from != receiver ) {
+            update_delegator_index( from, receiver, delegating );
+         }
+      } // itr can be invalid, should go out of scope
+
+      // update totals of "receiver"
+      {
+         user_resources_table   totals_tbl( get_self(), receiver.value );
+         auto tot_itr = totals_tbl.find( receiver.value );
+         if( tot_itr ==  totals_tbl.end() ) {
+            tot_itr = totals_tbl.emplace( from, [&]( auto& tot ) {
+                  tot.owner = receiver;
+                  tot.net_weight    = stake_net_delta;
+                  tot.cpu_weight    = stake_cpu_delta;
+               });
+         } else {
+            totals_tbl.modify( tot_itr, from == receiver ? from : same_payer, [&]( auto& tot ) {
+                  tot.net_weight    += stake_net_delta;
+                  tot.cpu_weight    += stake_cpu_delta;
+               });
+         }
+         check( 0 <= tot_itr->net_weight.amount, "insufficient staked total net bandwidth" );
+         check( 0 <= tot_itr->cpu_weight.amount, "insufficient staked total cpu bandwidth" );
+
+         {
+            bool ram_managed = false;
+            bool net_managed = false;
+            bool cpu_managed = false;
+
+            auto voter_itr = _voters.find( receiver.value );
+            if( voter_itr != _voters.end() ) {
+               ram_managed = has_field( voter_itr->flags1, voter_info::flags1_fields::ram_managed );
+               net_managed = has_field( voter_itr->flags1, voter_info::flags1_fields::net_managed );
+               cpu_managed = has_field( voter_itr->flags1, voter_info::flags1_fields::cpu_managed );
+            }
+
+            if( !(net_managed && cpu_managed) ) {
+               int64_t ram_bytes, net, cpu;
+               get_account_limits( receiver, ram_bytes, net, cpu );
+
+               set_account_limits( receiver,
+                                    ram_managed ? ram_bytes : std::max( tot_itr->ram_bytes + ram_gift_bytes, ram_bytes ),
+                                    net_managed ? net : tot_itr->net_weight.amount,
+                                    cpu_managed ? cpu : tot_itr->cpu_weight.amount );
+            }
+         }
+
+         if ( tot_itr->is_empty() ) {
+            totals_tbl.erase( tot_itr );
+         }
+      } // tot_itr can be invalid, should go out of scope
+   }
+
+   /**
+    *  Keeps the `delegators` row of `from` in the scope of `receiver` in step with their `delband` row.
+    *  Delegations made before the index existed get their row the first time they change.
+    */
+   void system_contract::update_delegator_index( const name& from, const name& receiver, bool delegating )
+   {
+      bw_delegator_table delegators( get_self(), receiver.value );
+      auto itr = delegators.find( from.value );
+      if ( delegating && itr == delegators.end() ) {
+         delegators.emplace( from, [&]( auto& d ) {
+            d.from = from;
+         });
+      } else if ( !delegating && itr != delegators.end() ) {
+         delegators.erase( itr );
+      }
+   }
+
+   void system_contract::update_voting_power( const name& voter, const asset& total_update, bool recalc_votes )
    {
       auto voter_itr = _voters.find( voter.value );
       if( voter_itr == _voters.end() ) {
@@ -364,7 +553,7 @@ namespace eosiosystem {
          validate_b1_vesting( voter_itr->staked );
       }
 
-      if( voter_itr->producers.size() || voter_itr->proxy ) {
+      if( recalc_votes && ( voter_itr->producers.size() || voter_itr->proxy ) ) {
          update_votes( voter, voter_itr->proxy, voter_itr->producers, false );
       }
    }
@@ -382,6 +571,34 @@ namespace eosiosystem {
       changebw( from, receiver, stake_net_quantity, stake_cpu_quantity, transfer);
    } // delegatebw
 
+   void system_contract::delegatebws( const name& from, const std::vector<bw_delegation>& delegations )
+   {
+      require_auth( from );
+      check( !delegations.empty(), "delegations can't be empty" );
+
+      asset zero_asset( 0, core_symbol() );
+      asset total_stake = zero_asset;
+      for ( const auto& d : delegations ) {
+         check( d.stake_net_quantity.symbol == core_symbol() && d.stake_cpu_quantity.symbol == core_symbol(),
+                "must stake core token" );
+         check( d.stake_cpu_quantity >= zero_asset, "must stake a positive amount" );
+         check( d.stake_net_quantity >= zero_asset, "must stake a positive amount" );
+         check( d.stake_net_quantity.amount + d.stake_cpu_quantity.amount > 0, "must stake a positive amount" );
+         check( d.receiver != from, "cannot delegate to self with delegatebws" );
+
+         update_delegation( from, d.receiver, d.stake_net_quantity, d.stake_cpu_quantity );
+         total_stake += d.stake_net_quantity + d.stake_cpu_quantity;
+      }
+
+      if ( stake_account != from ) {
+         token::transfer_action transfer_act{ token_account, { {from, active_permission} } };
+         transfer_act.send( from, stake_account, total_stake, "stake bandwidth" );
+      }
+
+      vote_stake_updater( from );
+      update_voting_power( from, total_stake );
+   } // delegatebws
+
    void system_contract::undelegatebw( const name& from, const name& receiver,
                                        const asset& unstake_net_quantity, const asset& unstake_cpu_quantity )
    {
@@ -408,6 +625,48 @@ namespace eosiosystem {
       token::transfer_action transfer_act{ token_account, { {stake_account, active_permission}, {req->owner, active_permission} } };
       transfer_act.send( stake_account, req->owner, req->net_amount + req->cpu_amount, "unstake" );
       refunds_tbl.erase( req );
+      update_refund_queue( owner, nullptr );
+   }
+
+   void system_contract::refundexec( const name& user, const std::vector<name>& owners ) {
+      require_auth( user );
+
+      const time_point_sec matured = time_point_sec( current_time_point() ) - refund_delay_sec;
+      for ( const auto& owner : owners ) {
+         refunds_table refunds_tbl( get_self(), owner.value );
+         auto req = refunds_tbl.find( owner.value );
+         if ( req == refunds_tbl.end() || req->request_time > matured ) {
+            continue;
+         }
+         token::transfer_action transfer_act{ token_account, { {stake_account, active_permission}, {req->owner, active_permission} } };
+         transfer_act.send( stake_account, req->owner, req->net_amount + req->cpu_amount, "unstake" );
+         refunds_tbl.erase( req );
+         update_refund_queue( owner, nullptr );
+      }
+   }
+
+   /**
+    *  Keeps the refund queue entry of `owner` in step with its refund request; `req` is null once
+    *  the request is gone. Requests created before the queue existed get an entry the first time
+    *  they change.
+    */
+   void system_contract::update_refund_queue( const name& owner, const refund_request* req ) {
+      refund_queue_table queue( get_self(), get_self().value );
+      auto itr = queue.find( owner.value );
+      if ( !req ) {
+         if ( itr != queue.end() ) {
+            queue.erase( itr );
+         }
+      } else if ( itr == queue.end() ) {
+         queue.emplace( owner, [&]( auto& q ) {
+            q.owner        = owner;
+            q.request_time = req->request_time;
+         });
+      } else if ( itr->request_time != req->request_time ) {
+         queue.modify( itr, same_payer, [&]( auto& q ) {
+            q.request_time = req->request_time;
+         });
+      }
    }
 
 
@@ -30,6 +30,7 @@ namespace eosiosystem {
     _rexretbuckets(get_self(), get_self().value),
     _rexfunds(get_self(), get_self().value),
     _rexbalance(get_self(), get_self().value),
+    _rexaccounts(get_self(), get_self().value),
     _rexorders(get_self(), get_self().value)
    {
       _gstate  = _global.exists() ? _global.get() : get_default_parameters();
@@ -58,6 +59,9 @@ namespace eosiosystem {
    }
 
    system_contract::~system_contract() {
+      if ( _read_only ) return;
+      flush_rex_accounts();
+      flush_account_limits();
       _global.set( _gstate, get_self() );
       _global2.set( _gstate2, get_self() );
       _global3.set( _gstate3, get_self() );
@@ -71,6 +75,8 @@ namespace eosiosystem {
       check( max_ram_size < 1024ll*1024*1024*1024*1024, "ram size is unrealistic" );
       check( max_ram_size > _gstate.total_ram_bytes_reserved, "attempt to set max below reserved" );
 
+      update_ram_price_accumulator();
+
       auto delta = int64_t(max_ram_size) - int64_t(_gstate.max_ram_size);
       auto itr = _rammarket.find(ramcore_symbol.raw());
 
@@ -85,6 +91,8 @@ namespace eosiosystem {
    }
 
    void system_contract::update_ram_supply() {
+      update_ram_price_accumulator();
+
       auto cbt = eosio::current_block_time();
 
       if( cbt <= _gstate2.last_ram_increase ) return;
@@ -102,6 +110,63 @@ namespace eosiosystem {
       _gstate2.last_ram_increase = cbt;
    }
 
+   /**
+    *  Resource limits are read from the chain the first time an account is accessed in the current
+    *  action. Later reads see the limits set since then.
+    */
+   void system_contract::get_account_limits( const name& account, int64_t& ram_bytes, int64_t& net_weight, int64_t& cpu_weight ) {
+      auto cached = _limits_cache.find( account );
+      if( cached == _limits_cache.end() ) {
+         cached = _limits_cache.emplace( account, resource_limits_cache{} ).first;
+         get_resource_limits( account, cached->second.ram_bytes, cached->second.net_weight, cached->second.cpu_weight );
+      }
+      ram_bytes  = cached->second.ram_bytes;
+      net_weight = cached->second.net_weight;
+      cpu_weight = cached->second.cpu_weight;
+   }
+
+   /**
+    *  Resource limits are applied by flush_account_limits(), once per account, when the action ends.
+    */
+   void system_contract::set_account_limits( const name& account, int64_t ram_bytes, int64_t net_weight, int64_t cpu_weight ) {
+      auto& cached = _limits_cache[account];
+      cached.ram_bytes  = ram_bytes;
+      cached.net_weight = net_weight;
+      cached.cpu_weight = cpu_weight;
+      cached.dirty      = true;
+   }
+
+   void system_contract::flush_account_limits() {
+      for( const auto& [account, limits] : _limits_cache ) {
+         if( limits.dirty ) {
+            set_resource_limits( account, limits.ram_bytes, limits.net_weight, limits.cpu_weight );
+         }
+      }
+   }
+
+   /**
+    *  Called before the ram market reserves change, so the reserves read here are the ones which
+    *  priced ram since the previous update. Reserves changed again within the same second are
+    *  picked up by the next update.
+    */
+   void system_contract::update_ram_price_accumulator() {
+      ram_price_accumulator_singleton acc_sing( get_self(), get_self().value );
+      const time_point_sec now = eosio::current_time_point();
+      auto acc = acc_sing.get_or_default();
+      if( acc_sing.exists() ) {
+         if( now <= acc.last_update ) return;
+
+         auto itr = _rammarket.find(ramcore_symbol.raw());
+         if( itr != _rammarket.end() && itr->base.balance.amount > 0 ) {
+            const uint128_t price = ( uint128_t(itr->quote.balance.amount) << ram_price_accumulator::price_fraction_bits )
+                                    / itr->base.balance.amount;
+            acc.price_cumulative += price * ( now.utc_seconds - acc.last_update.utc_seconds );
+         }
+      }
+      acc.last_update = now;
+      acc_sing.set( acc, get_self() );
+   }
+
    void system_contract::setramrate( uint16_t bytes_per_block ) {
       require_auth( get_self() );
 
@@ -144,14 +209,14 @@ namespace eosiosystem {
          check( !(ram_managed || net_managed || cpu_managed), "cannot use setalimits on an account with managed resources" );
       }
 
-      set_resource_limits( account, ram, net, cpu );
+      set_account_limits( account, ram, net, cpu );
    }
 
    void system_contract::setacctram( const name& account, const std::optional<int64_t>& ram_bytes ) {
       require_auth( get_self() );
 
       int64_t current_ram, current_net, current_cpu;
-      get_resource_limits( account, current_ram, current_net, current_cpu );
+      get_account_limits( account, current_ram, current_net, current_cpu );
 
       int64_t ram = 0;
 
@@ -189,14 +254,14 @@ namespace eosiosystem {
          ram = *ram_bytes;
       }
 
-      set_resource_limits( account, ram, current_net, current_cpu );
+      set_account_limits( account, ram, current_net, current_cpu );
    }
 
    void system_contract::setacctnet( const name& account, const std::optional<int64_t>& net_weight ) {
       require_auth( get_self() );
 
       int64_t current_ram, current_net, current_cpu;
-      get_resource_limits( account, current_ram, current_net, current_cpu );
+      get_account_limits( account, current_ram, current_net, current_cpu );
 
       int64_t net = 0;
 
@@ -233,14 +298,14 @@ namespace eosiosystem {
          net = *net_weight;
       }
 
-      set_resource_limits( account, current_ram, net, current_cpu );
+      set_account_limits( account, current_ram, net, current_cpu );
    }
 
    void system_contract::setacctcpu( const name& account, const std::optional<int64_t>& cpu_weight ) {
       require_auth( get_self() );
 
       int64_t current_ram, current_net, current_cpu;
-      get_resource_limits( account, current_ram, current_net, current_cpu );
+      get_account_limits( account, current_ram, current_net, current_cpu );
 
       int64_t cpu = 0;
 
@@ -277,7 +342,71 @@ namespace eosiosystem {
          cpu = *cpu_weight;
       }
 
-      set_resource_limits( account, current_ram, current_net, cpu );
+      set_account_limits( account, current_ram, current_net, cpu );
+   }
+
+   void system_contract::cfgnewacct( bool defer_userres ) {
+      require_auth( get_self() );
+
+      new_account_config_singleton config( get_self(), get_self().value );
+      config.set( new_account_config{ defer_userres }, get_self() );
+   }
+
+   void system_contract::setacctlims( const std::vector<account_limits>& limits ) {
+      require_auth( get_self() );
+
+      for( const auto& l : limits ) {
+         check( is_account( l.account ), "account does not exist" );
+         check( !l.ram_bytes || *l.ram_bytes >= 0, "not allowed to set RAM limit to unlimited" );
+         check( !l.net_weight || *l.net_weight >= -1, "invalid value for net_weight" );
+         check( !l.cpu_weight || *l.cpu_weight >= -1, "invalid value for cpu_weight" );
+
+         user_resources_table userres( get_self(), l.account.value );
+         auto ritr = userres.find( l.account.value );
+         const bool has_res = ritr != userres.end();
+
+         auto vitr = _voters.find( l.account.value );
+         const uint32_t current_flags1 = vitr != _voters.end() ? vitr->flags1 : 0;
+
+         // an empty field returns a managed resource to its staked amount and keeps an unmanaged one as it is,
+         // e.g. the limits set by `setalimits`
+         int64_t current_ram, current_net, current_cpu;
+         get_account_limits( l.account, current_ram, current_net, current_cpu );
+         auto limit = [&]( const std::optional<int64_t>& value, voter_info::flags1_fields field, int64_t staked, int64_t current ) {
+            if( value )
+               return *value;
+            return has_field( current_flags1, field ) ? staked : current;
+         };
+
+         const int64_t ram = limit( l.ram_bytes, voter_info::flags1_fields::ram_managed,
+                                    ram_gift_bytes + ( has_res ? ritr->ram_bytes : 0 ), current_ram );
+         const int64_t net = limit( l.net_weight, voter_info::flags1_fields::net_managed,
+                                    has_res ? ritr->net_weight.amount : 0, current_net );
+         const int64_t cpu = limit( l.cpu_weight, voter_info::flags1_fields::cpu_managed,
+                                    has_res ? ritr->cpu_weight.amount : 0, current_cpu );
+
+         auto set_flags = [&]( uint32_t flags1 ) {
+            flags1 = set_field( flags1, voter_info::flags1_fields::ram_managed, l.ram_bytes.has_value() );
+            flags1 = set_field( flags1, voter_info::flags1_fields::net_managed, l.net_weight.has_value() );
+            flags1 = set_field( flags1, voter_info::flags1_fields::cpu_managed, l.cpu_weight.has_value() );
+            return flags1;
+         };
+
+         if( vitr != _voters.end() ) {
+            if( set_flags( vitr->flags1 ) != vitr->flags1 ) {
+               _voters.modify( vitr, same_payer, [&]( auto& v ) {
+                  v.flags1 = set_flags( v.flags1 );
+               });
+            }
+         } else if( set_flags( 0 ) != 0 ) {
+            _voters.emplace( l.account, [&]( auto& v ) {
+               v.owner  = l.account;
+               v.flags1 = set_flags( 0 );
+            });
+         }
+
+         set_account_limits( l.account, ram, net, cpu );
+      }
    }
 
    void system_contract::activate( const eosio::checksum256& feature_digest ) {
@@ -314,6 +443,17 @@ namespace eosiosystem {
       _global4.set( _gstate4, get_self() );
    }
 
+   /**
+    *  True when one of the first 12 characters of `n` is a dot, which includes names shorter than 12
+    *  characters. All twelve 5-bit characters are tested at once: subtracting 1 from each of them sets
+    *  the top bit of a character that was zero, and of no character below the lowest zero one.
+    */
+   static constexpr bool has_dot_or_is_short( name n ) {
+      constexpr uint64_t char_low_bits  = 0x0842108421084210ull;   // lowest bit of each of the 12 characters
+      constexpr uint64_t char_high_bits = char_low_bits << 4;
+      return ( (n.value - char_low_bits) & ~n.value & char_high_bits ) != 0;
+   }
+
    /**
     *  Called after a new account is created. This code enforces resource-limits rules
     *  for new accounts as well as new account naming conventions.
@@ -329,22 +469,23 @@ namespace eosiosystem {
                             ignore<authority> active ) {
 
       if( creator != get_self() ) {
-         uint64_t tmp = newact.value >> 4;
-         bool has_dot = false;
-
-         for( uint32_t i = 0; i < 12; ++i ) {
-           has_dot |= !(tmp & 0x1f);
-           tmp >>= 5;
-         }
-         if( has_dot ) { // or is less than 12 characters
+         if( has_dot_or_is_short( newact ) ) {
             auto suffix = newact.suffix();
             if( suffix == newact ) {
-               name_bid_table bids(get_self(), get_self().value);
-               auto current = bids.find( newact.value );
-               check( current != bids.end(), "no active bid for name" );
-               check( current->high_bidder == creator, "only highest bidder can claim" );
-               check( current->high_bid < 0, "auction for name is not closed yet" );
-               bids.erase( current );
+               closed_name_bid_table closed(get_self(), get_self().value);
+               auto current = closed.find( newact.value );
+               if( current != closed.end() ) {
+                  check( current->high_bidder == creator, "only highest bidder can claim" );
+                  closed.erase( current );
+               } else {
+                  // open auctions and auctions closed before they were moved to `closedbids`
+                  name_bid_table bids(get_self(), get_self().value);
+                  auto bid = bids.find( newact.value );
+                  check( bid != bids.end(), "no active bid for name" );
+                  check( bid->high_bidder == creator, "only highest bidder can claim" );
+                  check( bid->high_bid < 0, "auction for name is not closed yet" );
+                  bids.erase( bid );
+               }
             } else {
                check( creator == suffix, "only suffix may create this account" );
             }
@@ -353,28 +494,63 @@ namespace eosiosystem {
 
       user_resources_table  userres( get_self(), newact.value );
 
+      pending_onboarding_table onboarding( get_self(), get_self().value );
+      auto pending = onboarding.find( newact.value );
+      if( pending == onboarding.end() ) {
+         new_account_config_singleton config( get_self(), get_self().value );
+         if( !config.exists() || !config.get().defer_userres ) {
+            userres.emplace( newact, [&]( auto& res ) {
+              res.owner = newact;
+              res.net_weight = asset( 0, system_contract::get_core_symbol() );
+              res.cpu_weight = asset( 0, system_contract::get_core_symbol() );
+            });
+         }
+         set_resource_limits( newact, 0, 0, 0 );
+         return;
+      }
+
+      // created by onboard: the account starts with the resources bought for it
       userres.emplace( newact, [&]( auto& res ) {
         res.owner = newact;
-        res.net_weight = asset( 0, system_contract::get_core_symbol() );
-        res.cpu_weight = asset( 0, system_contract::get_core_symbol() );
+        res.net_weight = pending->net_weight;
+        res.cpu_weight = pending->cpu_weight;
+        res.ram_bytes = pending->ram_bytes;
       });
 
-      set_resource_limits( newact, 0, 0, 0 );
+      const asset stake = pending->net_weight + pending->cpu_weight;
+      if( pending->transfer && stake.amount > 0 ) {
+         del_bandwidth_table del_tbl( get_self(), newact.value );
+         del_tbl.emplace( newact, [&]( auto& dbo ) {
+            dbo.from       = newact;
+            dbo.to         = newact;
+            dbo.net_weight = pending->net_weight;
+            dbo.cpu_weight = pending->cpu_weight;
+         });
+         // newaccount is only dispatched to system_contract
+         static_cast<system_contract*>( this )->update_voting_power( newact, stake );
+      }
+
+      set_resource_limits( newact, pending->ram_bytes + ram_gift_bytes, pending->net_weight.amount, pending->cpu_weight.amount );
+      onboarding.erase( pending );
    }
 
    void native::setabi( const name& acnt, const std::vector<char>& abi ) {
       eosio::multi_index< "abihash"_n, abi_hash >  table(get_self(), get_self().value);
+      const auto hash = eosio::sha256(const_cast<char*>(abi.data()), abi.size());
+      const uint32_t size = abi.size();
       auto itr = table.find( acnt.value );
       if( itr == table.end() ) {
          table.emplace( acnt, [&]( auto& row ) {
             row.owner = acnt;
-            row.hash = eosio::sha256(const_cast<char*>(abi.data()), abi.size());
+            row.hash = hash;
+            row.size.emplace( size );
          });
-      } else {
+      } else if( itr->hash != hash || !itr->size.has_value() || itr->size.value() != size ) {
          table.modify( itr, same_payer, [&]( auto& row ) {
-            row.hash = eosio::sha256(const_cast<char*>(abi.data()), abi.size());
+            row.hash = hash;
+            row.size.emplace( size );
          });
-      }
+      } // redeploying the same abi leaves the row untouched
    }
 
    void system_contract::init( unsigned_int version, const symbol& core ) {
@@ -1,7 +1,8 @@
 #include <eosio.system/eosio.system.hpp>
 #include <eosio.token/eosio.token.hpp>
 
-#include <eosio/transaction.hpp>
+#include <algorithm>
+#include <limits>
 
 namespace eosiosystem {
 
@@ -16,6 +17,10 @@ namespace eosiosystem {
       check( (newname.value & 0xFull) == 0, "13 character names are not valid account names to bid on" );
       check( (newname.value & 0x1F0ull) == 0, "accounts with 12 character names and no dots can be created without bidding required" );
       check( !is_account( newname ), "account already exists" );
+      {
+         closed_name_bid_table closed(get_self(), get_self().value);
+         check( closed.find( newname.value ) == closed.end(), "this auction has already closed" );
+      }
       check( bid.symbol == core_symbol(), "asset must be system token" );
       check( bid.amount > 0, "insufficient bid" );
       token::transfer_action transfer_act{ token_account, { {bidder, active_permission} } };
@@ -24,7 +29,7 @@ namespace eosiosystem {
       print( name{bidder}, " bid ", bid, " on ", name{newname}, "\n" );
       auto current = bids.find( newname.value );
       if( current == bids.end() ) {
-         bids.emplace( bidder, [&]( auto& b ) {
+         current = bids.emplace( bidder, [&]( auto& b ) {
             b.newname = newname;
             b.high_bidder = bidder;
             b.high_bid = bid.amount;
@@ -35,7 +40,8 @@ namespace eosiosystem {
          check( bid.amount - current->high_bid > (current->high_bid / 10), "must increase bid by 10%" );
          check( current->high_bidder != bidder, "account is already highest bidder" );
 
-         bid_refund_table refunds_table(get_self(), newname.value);
+         // outbid amounts accumulate in the previous high bidder's balance, which is claimed with bidrefunds
+         bid_refund_table refunds_table(get_self(), get_self().value);
 
          auto it = refunds_table.find( current->high_bidder.value );
          if ( it != refunds_table.end() ) {
@@ -49,22 +55,13 @@ namespace eosiosystem {
                });
          }
 
-         eosio::transaction t;
-         t.actions.emplace_back( permission_level{current->high_bidder, active_permission},
-                                 get_self(), "bidrefund"_n,
-                                 std::make_tuple( current->high_bidder, newname )
-         );
-         t.delay_sec = 0;
-         uint128_t deferred_id = (uint128_t(newname.value) << 64) | current->high_bidder.value;
-         eosio::cancel_deferred( deferred_id );
-         t.send( deferred_id, bidder );
-
          bids.modify( current, bidder, [&]( auto& b ) {
             b.high_bidder = bidder;
             b.high_bid = bid.amount;
             b.last_bid_time = current_time_point();
          });
       }
+      rank_name_bid( *current );
    }
 
    void system_contract::bidrefund( const name& bidder, const name& newname ) {
@@ -77,4 +74,72 @@ namespace eosiosystem {
       refunds_table.erase( it );
    }
 
+   void system_contract::bidrefunds( const name& bidder ) {
+      require_auth( bidder );
+
+      bid_refund_table refunds_table(get_self(), get_self().value);
+      auto it = refunds_table.find( bidder.value );
+      check( it != refunds_table.end(), "refund not found" );
+
+      token::transfer_action transfer_act{ token_account, { {names_account, active_permission}, {bidder, active_permission} } };
+      transfer_act.send( names_account, bidder, asset(it->amount), std::string("refund bids on names") );
+      refunds_table.erase( it );
+   }
+
+   static bool ranks_before( const name_bid_summary& a, const name_bid_summary& b ) {
+      return a.high_bid > b.high_bid || ( a.high_bid == b.high_bid && a.newname < b.newname );
+   }
+
+   /**
+    *  Bids only ever increase, so an auction outside the leaderboard can only enter it through its own
+    *  new bid and the leaderboard never needs the auctions it drops.
+    */
+   void system_contract::rank_name_bid( const name_bid& bid ) {
+      name_bid_leaderboard_singleton leaderboard(get_self(), get_self().value);
+      if( !leaderboard.exists() ) {
+         refresh_name_bid_leaderboard();
+         return;
+      }
+
+      auto board = leaderboard.get();
+      auto& top = board.top;
+      const name_bid_summary entry{ bid.newname, bid.high_bidder, bid.high_bid, bid.last_bid_time };
+      auto it = std::find_if( top.begin(), top.end(), [&]( const auto& s ) { return s.newname == bid.newname; } );
+      if( it == top.end() ) {
+         if( top.size() >= name_bid_leaderboard::max_size && !ranks_before( entry, top.back() ) ) {
+            return;
+         }
+         it = top.insert( top.end(), entry );
+      } else {
+         *it = entry;
+      }
+      std::sort( top.begin(), top.end(), ranks_before );
+      if( top.size() > name_bid_leaderboard::max_size ) {
+         top.pop_back();
+      }
+      leaderboard.set( board, get_self() );
+   }
+
+   /**
+    *  Rebuilds the leaderboard from the open auctions of the `highbid` index, once after an auction
+    *  closes and when the leaderboard does not exist yet.
+    */
+   name_bid_leaderboard system_contract::refresh_name_bid_leaderboard() {
+      name_bid_table bids(get_self(), get_self().value);
+      auto idx = bids.get_index<"highbid"_n>();
+
+      name_bid_leaderboard board;
+      for( auto it = idx.lower_bound( std::numeric_limits<uint64_t>::max()/2 );
+           it != idx.end() && board.top.size() < name_bid_leaderboard::max_size; ++it ) {
+         if( it->high_bid <= 0 ) {
+            break;
+         }
+         board.top.push_back( name_bid_summary{ it->newname, it->high_bidder, it->high_bid, it->last_bid_time } );
+      }
+
+      name_bid_leaderboard_singleton leaderboard(get_self(), get_self().value);
+      leaderboard.set( board, get_self() );
+      return board;
+   }
+
 }
@@ -1,6 +1,7 @@
 #include <eosio.system/eosio.system.hpp>
 #include <eosio/action.hpp>
 #include <eosio.system/powerup.results.hpp>
+#include <eosio.token/eosio.token.hpp>
 #include <algorithm>
 #include <cmath>
 
@@ -16,6 +17,8 @@ void update_weight(time_point_sec now, powerup_state_resource& res, int64_t& del
  */
 void update_utilization(time_point_sec now, powerup_state_resource& res);
 
+int64_t calc_powerup_price(const powerup_state_resource& state);
+
 void system_contract::adjust_resources(name payer, name account, symbol core_symbol, int64_t net_delta,
                                        int64_t cpu_delta, bool must_not_be_managed) {
    if (!net_delta && !cpu_delta)
@@ -55,8 +58,8 @@ void system_contract::adjust_resources(name payer, name account, symbol core_sym
 
       if (!(net_managed && cpu_managed)) {
          int64_t ram_bytes, net, cpu;
-         get_resource_limits(account, ram_bytes, net, cpu);
-         set_resource_limits(
+         get_account_limits(account, ram_bytes, net, cpu);
+         set_account_limits(
                account, ram_managed ? ram_bytes : std::max(tot_itr->ram_bytes + ram_gift_bytes, ram_bytes),
                net_managed ? net : tot_itr->net_weight.amount, cpu_managed ? cpu : tot_itr->cpu_weight.amount);
       }
@@ -69,23 +72,118 @@ void system_contract::adjust_resources(name payer, name account, symbol core_sym
 
 void system_contract::process_powerup_queue(time_point_sec now, symbol core_symbol, powerup_state& state,
                                            powerup_order_table& orders, uint32_t max_items, int64_t& net_delta_available,
-                                           int64_t& cpu_delta_available) {
+                                           int64_t& cpu_delta_available, bool dry_run, bool renew_subscriptions) {
    update_utilization(now, state.net);
    update_utilization(now, state.cpu);
+
+   // owners are adjusted once per pass, however many of their orders expired or were renewed
+   std::map<name, std::pair<int64_t, int64_t>> owner_deltas;
+   auto expire = [&](name owner, int64_t net_weight, int64_t cpu_weight) {
+      net_delta_available += net_weight;
+      cpu_delta_available += cpu_weight;
+      auto& owner_delta = owner_deltas[owner];
+      owner_delta.first  -= net_weight;
+      owner_delta.second -= cpu_weight;
+   };
+
+   // orders created before expiry buckets were introduced
    auto idx = orders.get_index<"byexpires"_n>();
-   while (max_items--) {
-      auto it = idx.begin();
-      if (it == idx.end() || it->expires > now)
-         break;
-      net_delta_available += it->net_weight;
-      cpu_delta_available += it->cpu_weight;
-      adjust_resources(get_self(), it->owner, core_symbol, -it->net_weight, -it->cpu_weight);
-      idx.erase(it);
+   for (auto it = idx.begin(); max_items && it != idx.end() && it->expires <= now; --max_items) {
+      expire(it->owner, it->net_weight, it->cpu_weight);
+      it = dry_run ? std::next(it) : idx.erase(it);
+   }
+
+   powerup_bucket_table buckets{ get_self(), 0 };
+   auto                 bucket_idx = buckets.get_index<"byexpires"_n>();
+   for (auto bucket = bucket_idx.begin(); max_items && bucket != bucket_idx.end() && bucket->expires <= now;) {
+      const uint32_t count = std::min<uint32_t>(max_items, bucket->orders.size());
+      for (uint32_t i = 0; i < count; ++i) {
+         const auto& order = bucket->orders[i];
+         expire(order.owner, order.net_weight, order.cpu_weight);
+      }
+      max_items -= count;
+      if (dry_run) {
+         ++bucket;
+      } else if (count == bucket->orders.size()) {
+         bucket = bucket_idx.erase(bucket);
+      } else {
+         bucket_idx.modify(bucket, same_payer, [&](auto& b) {
+            b.orders.erase(b.orders.begin(), b.orders.begin() + count);
+         });
+      }
    }
+
    state.net.utilization -= net_delta_available;
    state.cpu.utilization -= cpu_delta_available;
    update_weight(now, state.net, net_delta_available);
    update_weight(now, state.cpu, cpu_delta_available);
+
+   // subscriptions are only renewed once every order which expired by now has been released
+   if (renew_subscriptions && !dry_run && max_items)
+      renew_powerup_subscriptions(now, core_symbol, state, max_items, net_delta_available, cpu_delta_available,
+                                  owner_deltas);
+
+   if (!dry_run) {
+      for (const auto& [owner, delta] : owner_deltas) {
+         adjust_resources(get_self(), owner, core_symbol, delta.first, delta.second);
+      }
+      record_powerup_history(now, state);
+   }
+}
+
+void system_contract::record_powerup_history(time_point_sec now, powerup_state& state) {
+   // the sampling interval is tracked in the state so most passes never load the ring buffers
+   if (state.last_history_sample.has_value() &&
+       now.utc_seconds < state.last_history_sample.value().utc_seconds + powerup_history::sample_interval)
+      return;
+
+   powerup_history_singleton hist_sing{ get_self(), 0 };
+   auto                      hist = hist_sing.get_or_default();
+   if (!state.last_history_sample.has_value() && !hist.net.empty()) {
+      // state written before `last_history_sample` existed
+      const auto& last = hist.net[(hist.next + hist.net.size() - 1) % hist.net.size()];
+      if (now.utc_seconds < last.timestamp.utc_seconds + powerup_history::sample_interval)
+         return;
+   }
+
+   auto record = [&](std::vector<powerup_history_sample>& samples, const powerup_state_resource& res) {
+      powerup_history_sample sample{ now, res.utilization, res.adjusted_utilization, res.weight,
+                                     calc_powerup_price(res) };
+      if (samples.size() < powerup_history::max_samples)
+         samples.push_back(sample);
+      else
+         samples[hist.next] = sample;
+   };
+   record(hist.net, state.net);
+   record(hist.cpu, state.cpu);
+   hist.next = (hist.next + 1) % powerup_history::max_samples;
+   hist_sing.set(hist, get_self());
+   state.last_history_sample.emplace(now);
+}
+
+void system_contract::add_powerup_order(time_point_sec expires, name payer, name owner, int64_t net_weight,
+                                        int64_t cpu_weight) {
+   powerup_bucket_table buckets{ get_self(), 0 };
+   auto                 bucket_idx = buckets.get_index<"byexpires"_n>();
+   auto                 bucket     = bucket_idx.find((uint128_t(expires.utc_seconds) << 64) | payer.value);
+   if (bucket == bucket_idx.end()) {
+      buckets.emplace(payer, [&](auto& b) {
+         b.id      = buckets.available_primary_key();
+         b.payer   = payer;
+         b.expires = expires;
+         b.orders.push_back(powerup_bucket_entry{ owner, net_weight, cpu_weight });
+      });
+      return;
+   }
+   bucket_idx.modify(bucket, same_payer, [&](auto& b) {
+      auto it = std::find_if(b.orders.begin(), b.orders.end(), [&](const auto& o) { return o.owner == owner; });
+      if (it == b.orders.end()) {
+         b.orders.push_back(powerup_bucket_entry{ owner, net_weight, cpu_weight });
+      } else {
+         it->net_weight += net_weight;
+         it->cpu_weight += cpu_weight;
+      }
+   });
 }
 
 void update_weight(time_point_sec now, powerup_state_resource& res, int64_t& delta_available) {
@@ -252,14 +350,42 @@ void system_contract::cfgpowerup(powerup_config& args) {
    state_sing.set(state, get_self());
 } // system_contract::configpower
 
+// Evaluates u ^ exponent and u ^ (exponent - 1.0) for an arbitrary exponent.
+struct generic_fee_kernel {
+   double exponent;
+
+   double pow(double u) const { return std::pow(u, exponent); }
+   double pow_minus_one(double u) const { return std::pow(u, exponent - 1.0); }
+};
+
+template <int N>
+double integer_pow(double u) {
+   if constexpr (N == 0) {
+      return 1.0;
+   } else {
+      return u * integer_pow<N - 1>(u);
+   }
+}
+
+// Evaluates u ^ Exponent and u ^ (Exponent - 1) with plain multiplications.
+template <int Exponent>
+struct integer_fee_kernel {
+   static_assert(Exponent >= 1);
+
+   double pow(double u) const { return integer_pow<Exponent>(u); }
+   double pow_minus_one(double u) const { return integer_pow<Exponent - 1>(u); }
+};
+
 /**
  *  @pre 0 <= state.min_price.amount <= state.max_price.amount
  *  @pre 0 < state.max_price.amount
  *  @pre 1.0 <= state.exponent
  *  @pre 0 <= state.utilization <= state.adjusted_utilization <= state.weight
  *  @pre 0 <= utilization_increase <= (state.weight - state.utilization)
+ *  @pre kernel evaluates powers of state.exponent
  */
-int64_t calc_powerup_fee(const powerup_state_resource& state, int64_t utilization_increase) {
+template <typename Kernel>
+int64_t calc_powerup_fee(const powerup_state_resource& state, int64_t utilization_increase, const Kernel& kernel) {
    if( utilization_increase <= 0 ) return 0;
 
    // Let p(u) = price as a function of the utilization fraction u which is defined for u in [0.0, 1.0].
@@ -271,17 +397,17 @@ int64_t calc_powerup_fee(const powerup_state_resource& state, int64_t utilizatio
    // Returns f(double(end_utilization)/state.weight) - f(double(start_utilization)/state.weight) which is equivalent to
    // the integral of p(x) from x = double(start_utilization)/state.weight to x = double(end_utilization)/state.weight.
    // @pre 0 <= start_utilization <= end_utilization <= state.weight
-   auto price_integral_delta = [&state](int64_t start_utilization, int64_t end_utilization) -> double {
+   auto price_integral_delta = [&state, &kernel](int64_t start_utilization, int64_t end_utilization) -> double {
       double coefficient = (state.max_price.amount - state.min_price.amount) / state.exponent;
       double start_u     = double(start_utilization) / state.weight;
       double end_u       = double(end_utilization) / state.weight;
       return state.min_price.amount * end_u - state.min_price.amount * start_u +
-               coefficient * std::pow(end_u, state.exponent) - coefficient * std::pow(start_u, state.exponent);
+               coefficient * kernel.pow(end_u) - coefficient * kernel.pow(start_u);
    };
 
    // Returns p(double(utilization)/state.weight).
    // @pre 0 <= utilization <= state.weight
-   auto price_function = [&state](int64_t utilization) -> double {
+   auto price_function = [&state, &kernel](int64_t utilization) -> double {
       double price = state.min_price.amount;
       // state.exponent >= 1.0, therefore the exponent passed into std::pow is >= 0.0.
       // Since the exponent passed into std::pow could be 0.0 and simultaneously so could double(utilization)/state.weight,
@@ -291,7 +417,7 @@ int64_t calc_powerup_fee(const powerup_state_resource& state, int64_t utilizatio
       if (new_exponent <= 0.0) {
          return state.max_price.amount;
       } else {
-         price += (state.max_price.amount - state.min_price.amount) * std::pow(double(utilization) / state.weight, new_exponent);
+         price += (state.max_price.amount - state.min_price.amount) * kernel.pow_minus_one(double(utilization) / state.weight);
       }
 
       return price;
@@ -314,6 +440,145 @@ int64_t calc_powerup_fee(const powerup_state_resource& state, int64_t utilizatio
    return std::ceil(fee);
 }
 
+// Calls f with the kernel for `exponent`; integer exponents, including the default of 2.0, are evaluated without std::pow
+template <typename F>
+int64_t with_fee_kernel(double exponent, F&& f) {
+   if (exponent == 1.0)
+      return f(integer_fee_kernel<1>{});
+   if (exponent == 2.0)
+      return f(integer_fee_kernel<2>{});
+   if (exponent == 3.0)
+      return f(integer_fee_kernel<3>{});
+   return f(generic_fee_kernel{ exponent });
+}
+
+int64_t calc_powerup_fee(const powerup_state_resource& state, int64_t utilization_increase) {
+   return with_fee_kernel(state.exponent, [&](const auto& kernel) {
+      return calc_powerup_fee(state, utilization_increase, kernel);
+   });
+}
+
+/**
+ *  Returns the price p(u) at the adjusted utilization, i.e. the fee for the whole market weight at the
+ *  current marginal price.
+ *
+ *  @pre 0 <= state.min_price.amount <= state.max_price.amount
+ *  @pre 1.0 <= state.exponent
+ *  @pre 0 <= state.adjusted_utilization <= state.weight
+ */
+int64_t calc_powerup_price(const powerup_state_resource& state) {
+   if (state.weight <= 0)
+      return state.min_price.amount;
+   double u = double(state.adjusted_utilization) / state.weight;
+   return with_fee_kernel(state.exponent, [&](const auto& kernel) {
+      return state.min_price.amount +
+             static_cast<int64_t>((state.max_price.amount - state.min_price.amount) * kernel.pow_minus_one(u));
+   });
+}
+
+/**
+ *  Prices a powerup of `receiver` at the current market state and adds the powered up
+ *  resources to the market utilization.
+ */
+powerup_quote quote_powerup(powerup_state& state, const powerup_receiver& receiver, symbol core_symbol) {
+   eosio::check(receiver.net_frac >= 0, "net_frac can't be negative");
+   eosio::check(receiver.cpu_frac >= 0, "cpu_frac can't be negative");
+   eosio::check(receiver.net_frac <= powerup_frac, "net can't be more than 100%");
+   eosio::check(receiver.cpu_frac <= powerup_frac, "cpu can't be more than 100%");
+
+   powerup_quote quote{ asset{ 0, core_symbol } };
+   auto          process = [&](int64_t frac, int64_t& amount, powerup_state_resource& state) {
+      if (!frac)
+         return;
+      amount = static_cast<int128_t>(frac) * state.weight / powerup_frac;
+      eosio::check(state.weight, "market doesn't have resources available");
+      eosio::check(state.utilization + amount <= state.weight, "market doesn't have enough resources available");
+      int64_t f = calc_powerup_fee(state, amount);
+      eosio::check(f > 0, "calculated fee is below minimum; try powering up with more resources");
+      quote.fee.amount += f;
+      state.utilization += amount;
+   };
+
+   process(receiver.net_frac, quote.powup_net, state.net);
+   process(receiver.cpu_frac, quote.powup_cpu, state.cpu);
+   return quote;
+}
+
+void system_contract::renew_powerup_subscriptions(time_point_sec now, symbol core_symbol, powerup_state& state,
+                                                  uint32_t max_items, int64_t& net_delta_available,
+                                                  int64_t& cpu_delta_available,
+                                                  std::map<name, std::pair<int64_t, int64_t>>& owner_deltas) {
+   powerup_subscription_table subs{ get_self(), 0 };
+   auto                       idx = subs.get_index<"byexpires"_n>();
+
+   // quote_powerup aborts the transaction on failure, which must not block the queue for everyone else
+   auto has_capacity = [](int64_t frac, const powerup_state_resource& res) {
+      if (!frac)
+         return true;
+      int64_t amount = static_cast<int128_t>(frac) * res.weight / powerup_frac;
+      return res.weight && res.utilization + amount <= res.weight;
+   };
+   auto has_fee = [](int64_t frac, const powerup_state_resource& res) {
+      return !frac || calc_powerup_fee(res, static_cast<int128_t>(frac) * res.weight / powerup_frac) > 0;
+   };
+
+   asset fee{ 0, core_symbol };
+   // skipped subscriptions don't use up max_items, but at most max_items of them are examined per pass
+   uint32_t max_skipped = max_items;
+   for (auto it = idx.begin(); max_items && it != idx.end() && it->expires <= now;) {
+      // the market is full; retried by the next pass
+      if (!has_capacity(it->net_frac, state.net) || !has_capacity(it->cpu_frac, state.cpu)) {
+         if (!max_skipped)
+            break;
+         --max_skipped;
+         ++it;
+         continue;
+      }
+      --max_items;
+
+      std::optional<powerup_quote> quote;
+      if (has_fee(it->net_frac, state.net) && has_fee(it->cpu_frac, state.cpu)) {
+         auto priced = state;
+         quote       = quote_powerup(priced, powerup_receiver{ it->receiver, it->net_frac, it->cpu_frac }, core_symbol);
+         if (quote->fee >= state.min_powerup_fee && quote->fee <= it->max_fee && quote->fee <= it->balance)
+            state = priced;
+         else
+            quote.reset();
+      }
+
+      // the subscription ends; its balance stays claimable by the payer through powupunsub
+      if (!quote) {
+         auto next = std::next(it);
+         idx.modify(it, same_payer, [&](auto& sub) {
+            sub.net_frac = 0;
+            sub.cpu_frac = 0;
+            sub.expires  = time_point_sec::maximum();
+         });
+         it = next;
+         continue;
+      }
+
+      net_delta_available -= quote->powup_net;
+      cpu_delta_available -= quote->powup_cpu;
+      auto& owner_delta = owner_deltas[it->receiver];
+      owner_delta.first  += quote->powup_net;
+      owner_delta.second += quote->powup_cpu;
+      add_powerup_order(now + eosio::days(state.powerup_days), it->payer, it->receiver, quote->powup_net,
+                        quote->powup_cpu);
+      fee += quote->fee;
+      // the renewed row moves past `now` in the index, behind any subscription skipped above
+      auto next = std::next(it);
+      idx.modify(it, same_payer, [&](auto& sub) {
+         sub.balance -= quote->fee;
+         sub.expires = now + eosio::days(state.powerup_days);
+      });
+      it = next;
+   }
+
+   if (fee.amount > 0)
+      channel_to_rex_or_pools(get_self(), fee, true);
+}
+
 void system_contract::powerupexec(const name& user, uint16_t max) {
    require_auth(user);
    powerup_state_singleton state_sing{ get_self(), 0 };
@@ -325,7 +590,28 @@ void system_contract::powerupexec(const name& user, uint16_t max) {
 
    int64_t net_delta_available = 0;
    int64_t cpu_delta_available = 0;
-   process_powerup_queue(now, core_symbol, state, orders, max, net_delta_available, cpu_delta_available);
+   process_powerup_queue(now, core_symbol, state, orders, max, net_delta_available, cpu_delta_available, false,
+                         true);
+
+   adjust_resources(get_self(), reserv_account, core_symbol, net_delta_available, cpu_delta_available, true);
+   state_sing.set(state, get_self());
+}
+
+void system_contract::powerupexec2(const name& user, uint32_t budget) {
+   require_auth(user);
+   powerup_state_singleton state_sing{ get_self(), 0 };
+   powerup_order_table     orders{ get_self(), 0 };
+   eosio::check(state_sing.exists(), "powerup hasn't been initialized");
+   auto           state       = state_sing.get();
+   time_point_sec now         = eosio::current_time_point();
+   auto           core_symbol = get_core_symbol();
+
+   // expired orders are erased as they are processed, so the oldest remaining order or bucket is
+   // where the next call resumes
+   int64_t net_delta_available = 0;
+   int64_t cpu_delta_available = 0;
+   process_powerup_queue(now, core_symbol, state, orders, budget / powerup_order_work_units, net_delta_available,
+                         cpu_delta_available, false, true);
 
    adjust_resources(get_self(), reserv_account, core_symbol, net_delta_available, cpu_delta_available, true);
    state_sing.set(state, get_self());
@@ -334,65 +620,145 @@ void system_contract::powerupexec(const name& user, uint16_t max) {
 void system_contract::powerup(const name& payer, const name& receiver, uint32_t days, int64_t net_frac, int64_t cpu_frac,
                              const asset& max_payment) {
    require_auth(payer);
+   powerup_receivers(payer, { powerup_receiver{ receiver, net_frac, cpu_frac } }, days, max_payment);
+}
+
+void system_contract::powerupmany(const name& payer, const std::vector<powerup_receiver>& receivers, uint32_t days,
+                                  const asset& max_payment) {
+   require_auth(payer);
+   eosio::check(!receivers.empty(), "receivers can't be empty");
+   powerup_receivers(payer, receivers, days, max_payment);
+}
+
+powerup_quote system_contract::powerupquote(uint32_t days, int64_t net_frac, int64_t cpu_frac) {
+   _read_only = true;
    powerup_state_singleton state_sing{ get_self(), 0 };
    powerup_order_table     orders{ get_self(), 0 };
    eosio::check(state_sing.exists(), "powerup hasn't been initialized");
    auto           state       = state_sing.get();
    time_point_sec now         = eosio::current_time_point();
    auto           core_symbol = get_core_symbol();
-   eosio::check(max_payment.symbol == core_symbol, "max_payment doesn't match core symbol");
    eosio::check(days == state.powerup_days, "days doesn't match configuration");
+
+   // same steps as powerup, applied to a copy of the state only
+   int64_t net_delta_available = 0;
+   int64_t cpu_delta_available = 0;
+   process_powerup_queue(now, core_symbol, state, orders, 2, net_delta_available, cpu_delta_available, true);
+
+   auto quote = quote_powerup(state, powerup_receiver{ name(), net_frac, cpu_frac }, core_symbol);
+   eosio::check(quote.fee >= state.min_powerup_fee, "calculated fee is below minimum; try powering up with more resources");
+   return quote;
+}
+
+void system_contract::powupsub(const name& payer, const name& receiver, int64_t net_frac, int64_t cpu_frac,
+                               const asset& max_fee, const asset& deposit) {
+   require_auth(payer);
+   powerup_state_singleton state_sing{ get_self(), 0 };
+   eosio::check(state_sing.exists(), "powerup hasn't been initialized");
+   auto core_symbol = get_core_symbol();
+   eosio::check(eosio::is_account(receiver), "receiver account does not exist");
    eosio::check(net_frac >= 0, "net_frac can't be negative");
    eosio::check(cpu_frac >= 0, "cpu_frac can't be negative");
    eosio::check(net_frac <= powerup_frac, "net can't be more than 100%");
    eosio::check(cpu_frac <= powerup_frac, "cpu can't be more than 100%");
+   eosio::check(net_frac || cpu_frac, "net_frac or cpu_frac must be positive");
+   eosio::check(max_fee.symbol == core_symbol, "max_fee doesn't match core symbol");
+   eosio::check(max_fee.amount > 0, "max_fee must be positive");
+   eosio::check(deposit.symbol == core_symbol, "deposit doesn't match core symbol");
+   eosio::check(deposit.amount >= 0, "deposit can't be negative");
+
+   powerup_subscription_table subs{ get_self(), 0 };
+   auto                       it = subs.find(receiver.value);
+   if (it == subs.end()) {
+      subs.emplace(payer, [&](auto& sub) {
+         sub.receiver = receiver;
+         sub.payer    = payer;
+         sub.net_frac = net_frac;
+         sub.cpu_frac = cpu_frac;
+         sub.max_fee  = max_fee;
+         sub.balance  = deposit;
+         sub.expires  = eosio::current_time_point();
+      });
+   } else {
+      eosio::check(it->payer == payer, "receiver is subscribed by another payer");
+      subs.modify(it, same_payer, [&](auto& sub) {
+         sub.net_frac = net_frac;
+         sub.cpu_frac = cpu_frac;
+         sub.max_fee  = max_fee;
+         sub.balance += deposit;
+         // an ended subscription is renewed again by the next queue processing
+         if (sub.expires == time_point_sec::maximum())
+            sub.expires = eosio::current_time_point();
+      });
+   }
+
+   if (deposit.amount > 0) {
+      eosio::token::transfer_action transfer_act{ token_account, { payer, active_permission } };
+      transfer_act.send(payer, get_self(), deposit, "powerup subscription deposit");
+   }
+}
+
+void system_contract::powupunsub(const name& payer, const name& receiver) {
+   require_auth(payer);
+   powerup_subscription_table subs{ get_self(), 0 };
+   const auto&                sub = subs.get(receiver.value, "receiver has no powerup subscription");
+   eosio::check(sub.payer == payer, "receiver is subscribed by another payer");
+   if (sub.balance.amount > 0) {
+      eosio::token::transfer_action transfer_act{ token_account, { get_self(), active_permission } };
+      transfer_act.send(get_self(), payer, sub.balance, "powerup subscription cancelled");
+   }
+   subs.erase(sub);
+}
+
+void system_contract::powerup_receivers(const name& payer, const std::vector<powerup_receiver>& receivers, uint32_t days,
+                                        const asset& max_payment) {
+   powerup_state_singleton state_sing{ get_self(), 0 };
+   powerup_order_table     orders{ get_self(), 0 };
+   eosio::check(state_sing.exists(), "powerup hasn't been initialized");
+   auto           state       = state_sing.get();
+   time_point_sec now         = eosio::current_time_point();
+   auto           core_symbol = get_core_symbol();
+   eosio::check(max_payment.symbol == core_symbol, "max_payment doesn't match core symbol");
+   eosio::check(days == state.powerup_days, "days doesn't match configuration");
 
    int64_t net_delta_available = 0;
    int64_t cpu_delta_available = 0;
    process_powerup_queue(now, core_symbol, state, orders, 2, net_delta_available, cpu_delta_available);
 
-   eosio::asset fee{ 0, core_symbol };
-   auto         process = [&](int64_t frac, int64_t& amount, powerup_state_resource& state) {
-      if (!frac)
-         return;
-      amount = static_cast<int128_t>(frac) * state.weight / powerup_frac;
-      eosio::check(state.weight, "market doesn't have resources available");
-      eosio::check(state.utilization + amount <= state.weight, "market doesn't have enough resources available");
-      int64_t f = calc_powerup_fee(state, amount);
-      eosio::check(f > 0, "calculated fee is below minimum; try powering up with more resources");
-      fee.amount += f;
-      state.utilization += amount;
-   };
-
-   int64_t net_amount = 0;
-   int64_t cpu_amount = 0;
-   process(net_frac, net_amount, state.net);
-   process(cpu_frac, cpu_amount, state.cpu);
+   // each receiver is priced at the utilization left by the receivers before it
+   eosio::asset               fee{ 0, core_symbol };
+   std::vector<powerup_quote> quotes;
+   quotes.reserve(receivers.size());
+   for (const auto& r : receivers) {
+      quotes.push_back(quote_powerup(state, r, core_symbol));
+      fee += quotes.back().fee;
+   }
    if (fee > max_payment) {
       std::string error_msg = "max_payment is less than calculated fee: ";
       error_msg += fee.to_string();
       eosio::check(false, error_msg);
    }
-   eosio::check(fee >= state.min_powerup_fee, "calculated fee is below minimum; try powering up with more resources");
-
-   orders.emplace(payer, [&](auto& order) {
-      order.id         = orders.available_primary_key();
-      order.owner      = receiver;
-      order.net_weight = net_amount;
-      order.cpu_weight = cpu_amount;
-      order.expires    = now + eosio::days(days);
-   });
-   net_delta_available -= net_amount;
-   cpu_delta_available -= cpu_amount;
 
-   adjust_resources(payer, receiver, core_symbol, net_amount, cpu_amount, true);
+   int64_t net_total = 0;
+   int64_t cpu_total = 0;
+   for (size_t i = 0; i < receivers.size(); ++i) {
+      const auto& quote = quotes[i];
+      eosio::check(quote.fee >= state.min_powerup_fee, "calculated fee is below minimum; try powering up with more resources");
+      add_powerup_order(now + eosio::days(days), payer, receivers[i].receiver, quote.powup_net, quote.powup_cpu);
+      adjust_resources(payer, receivers[i].receiver, core_symbol, quote.powup_net, quote.powup_cpu, true);
+      net_total += quote.powup_net;
+      cpu_total += quote.powup_cpu;
+   }
+   net_delta_available -= net_total;
+   cpu_delta_available -= cpu_total;
+
    adjust_resources(get_self(), reserv_account, core_symbol, net_delta_available, cpu_delta_available, true);
    channel_to_rex_or_pools(payer, fee, true);
    state_sing.set(state, get_self());
 
    // inline noop action
    powup_results::powupresult_action powupresult_act{ reserv_account, std::vector<eosio::permission_level>{ } };
-   powupresult_act.send( fee, net_amount, cpu_amount );
+   powupresult_act.send( fee, net_total, cpu_total );
 }
 
 } // namespace eosiosystem
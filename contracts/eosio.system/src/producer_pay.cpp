@@ -23,6 +23,9 @@ namespace eosiosystem {
       // is eventually completely removed, at which point this line can be removed.
       _gstate2.last_block_num = timestamp;
 
+      /// recalculate votes of voters whose REX vote stake drifted
+      sync_rex_votes( rex_vote_sync_per_block );
+
       /** until activation, no new rewards are paid */
       if( _gstate.thresh_activated_stake_time == time_point() )
          return;
@@ -48,20 +51,24 @@ namespace eosiosystem {
          update_elected_producers( timestamp );
 
          if( (timestamp.slot - _gstate.last_name_close.slot) > blocks_per_day ) {
-            name_bid_table bids(get_self(), get_self().value);
-            auto idx = bids.get_index<"highbid"_n>();
-            auto highest = idx.lower_bound( std::numeric_limits<uint64_t>::max()/2 );
-            if( highest != idx.end() &&
-                highest->high_bid > 0 &&
-                (current_time_point() - highest->last_bid_time) > microseconds(useconds_per_day) &&
+            name_bid_leaderboard_singleton leaderboard(get_self(), get_self().value);
+            const auto board = leaderboard.exists() ? leaderboard.get() : refresh_name_bid_leaderboard();
+            if( !board.top.empty() &&
+                (current_time_point() - board.top.front().last_bid_time) > microseconds(useconds_per_day) &&
                 _gstate.thresh_activated_stake_time > time_point() &&
                 (current_time_point() - _gstate.thresh_activated_stake_time) > microseconds(14 * useconds_per_day)
             ) {
                _gstate.last_name_close = timestamp;
-               channel_namebid_to_rex_or_pools( highest->high_bid );
-               idx.modify( highest, same_payer, [&]( auto& b ){
-                  b.high_bid = -b.high_bid;
+               name_bid_table bids(get_self(), get_self().value);
+               const auto& highest = bids.get( board.top.front().newname.value );
+               channel_namebid_to_rex_or_pools( highest.high_bid );
+               closed_name_bid_table closed(get_self(), get_self().value);
+               closed.emplace( highest.high_bidder, [&]( auto& b ){
+                  b = highest;
+                  b.high_bid = -highest.high_bid;
                });
+               bids.erase( highest );
+               refresh_name_bid_leaderboard();
             }
          }
       }
@@ -74,6 +74,9 @@ namespace eosiosystem {
          });
          if ( del_itr->is_empty() ) {
             dbw_table.erase( del_itr );
+            if ( owner != receiver ) {
+               update_delegator_index( owner, receiver, false );
+            }
          }
       }
 
@@ -100,13 +103,14 @@ namespace eosiosystem {
 
       runrex(2);
 
-      auto bitr = _rexbalance.require_find( from.value, "user must first buyrex" );
-      check( rex.amount > 0 && rex.symbol == bitr->rex_balance.symbol,
+      auto& racct = get_rex_account( from );
+      check( racct.acct.has_rex_balance(), "user must first buyrex" );
+      check( rex.amount > 0 && rex.symbol == racct.acct.rex_balance.symbol,
              "asset must be a positive amount of (REX, 4)" );
-      process_rex_maturities( bitr );
-      check( rex.amount <= bitr->matured_rex, "insufficient available rex" );
+      process_rex_maturities( racct );
+      check( rex.amount <= racct.acct.matured_rex, "insufficient available rex" );
 
-      const auto current_order = fill_rex_order( bitr, rex );
+      const auto current_order = fill_rex_order( racct, rex );
       if ( current_order.success && current_order.proceeds.amount == 0 ) {
          check( false, "proceeds are negligible" );
       }
@@ -136,7 +140,7 @@ namespace eosiosystem {
          }
          pending_sell_order.amount = oitr->rex_requested.amount;
       }
-      check( pending_sell_order.amount <= bitr->matured_rex, "insufficient funds for current and scheduled orders" );
+      check( pending_sell_order.amount <= racct.acct.matured_rex, "insufficient funds for current and scheduled orders" );
       // dummy action added so that sell order proceeds show up in action trace
       if ( current_order.success ) {
          rex_results::sellresult_action sellrex_act( rex_account, std::vector<eosio::permission_level>{ } );
@@ -209,24 +213,24 @@ namespace eosiosystem {
 
       runrex(2);
 
-      auto itr = _rexbalance.require_find( owner.value, "account has no REX balance" );
-      const asset init_stake = itr->vote_stake;
+      auto& racct = get_rex_account( owner );
+      check( racct.acct.has_rex_balance(), "account has no REX balance" );
+      const asset init_stake = racct.acct.vote_stake;
 
       auto rexp_itr = _rexpool.begin();
       const int64_t total_rex      = rexp_itr->total_rex.amount;
       const int64_t total_lendable = rexp_itr->total_lendable.amount;
-      const int64_t rex_balance    = itr->rex_balance.amount;
+      const int64_t rex_balance    = racct.acct.rex_balance.amount;
 
       asset current_stake( 0, core_symbol() );
       if ( total_rex > 0 ) {
          current_stake.amount = ( uint128_t(rex_balance) * total_lendable ) / total_rex;
       }
-      _rexbalance.modify( itr, same_payer, [&]( auto& rb ) {
-         rb.vote_stake = current_stake;
-      });
+      racct.acct.vote_stake = current_stake;
+      racct.balance_dirty   = true;
 
       update_rex_account( owner, asset( 0, core_symbol() ), current_stake - init_stake, true );
-      process_rex_maturities( itr );
+      process_rex_maturities( racct );
    }
 
    void system_contract::setrex( const asset& balance )
@@ -248,15 +252,80 @@ namespace eosiosystem {
       runrex( max );
    }
 
+   void system_contract::matchrex( const name& user, uint16_t max )
+   {
+      require_auth( user );
+
+      begin_rex_maintenance();
+      process_expired_rex_loans( max );
+
+      const auto fills = fill_rex_orders( max );
+      if ( !fills.empty() ) {
+         /// send dummy action to show owners and proceeds of all filled sellrex orders
+         rex_results::orderresults_action orders_act( rex_account, std::vector<eosio::permission_level>{ } );
+         orders_act.send( fills );
+      }
+   }
+
+   void system_contract::rexexec2( const name& user, uint32_t budget )
+   {
+      require_auth( user );
+
+      begin_rex_maintenance();
+
+      rex_exec_cursor_singleton cursor_sing( get_self(), get_self().value );
+      auto cursor = cursor_sing.get_or_default();
+      std::vector<std::pair<name, asset>> fills;
+
+      /// visit each stage at most once, starting where the previous call stopped
+      for ( uint8_t i = 0; i < rex_exec_cursor::num_stages; ++i ) {
+         bool stage_done = false;
+         if ( cursor.stage == rex_exec_cursor::sell_orders_stage ) {
+            const uint32_t max = budget / rex_order_work_units;
+            if ( max == 0 ) break;
+            uint32_t examined = 0;
+            const auto stage_fills = fill_rex_orders( max, cursor.order_time, examined );
+            fills.insert( fills.end(), stage_fills.begin(), stage_fills.end() );
+            budget    -= examined * rex_order_work_units;
+            stage_done = cursor.order_time == 0;
+         } else {
+            const uint32_t max = budget / rex_loan_work_units;
+            if ( max == 0 ) break;
+            const bool     cpu       = cursor.stage == rex_exec_cursor::cpu_loans_stage;
+            const uint32_t processed = cpu ? process_expired_loans<rex_cpu_loan_table>( true, max )
+                                           : process_expired_loans<rex_net_loan_table>( false, max );
+            budget    -= processed * rex_loan_work_units;
+            stage_done = processed < max;
+         }
+         if ( !stage_done ) break;
+         cursor.stage = ( cursor.stage + 1 ) % rex_exec_cursor::num_stages;
+      }
+      cursor_sing.set( cursor, get_self() );
+
+      if ( !fills.empty() ) {
+         /// send dummy action to show owners and proceeds of all filled sellrex orders
+         rex_results::orderresults_action orders_act( rex_account, std::vector<eosio::permission_level>{ } );
+         orders_act.send( fills );
+      }
+   }
+
+   void system_contract::syncrexvotes( const name& user, uint16_t max )
+   {
+      require_auth( user );
+
+      sync_rex_votes( max );
+   }
+
    void system_contract::consolidate( const name& owner )
    {
       require_auth( owner );
 
       runrex(2);
 
-      auto bitr = _rexbalance.require_find( owner.value, "account has no REX balance" );
+      auto& racct = get_rex_account( owner );
+      check( racct.acct.has_rex_balance(), "account has no REX balance" );
       asset rex_in_sell_order = update_rex_account( owner, asset( 0, core_symbol() ), asset( 0, core_symbol() ) );
-      consolidate_rex_balance( bitr, rex_in_sell_order );
+      consolidate_rex_balance( racct, rex_in_sell_order );
    }
 
    void system_contract::mvtosavings( const name& owner, const asset& rex )
@@ -265,22 +334,20 @@ namespace eosiosystem {
 
       runrex(2);
 
-      auto bitr = _rexbalance.require_find( owner.value, "account has no REX balance" );
-      check( rex.amount > 0 && rex.symbol == bitr->rex_balance.symbol, "asset must be a positive amount of (REX, 4)" );
-      const asset   rex_in_sell_order = update_rex_account( owner, asset( 0, core_symbol() ), asset( 0, core_symbol() ) );
-      const int64_t rex_in_savings    = read_rex_savings( bitr );
-      check( rex.amount + rex_in_sell_order.amount + rex_in_savings <= bitr->rex_balance.amount,
+      auto& racct = get_rex_account( owner );
+      check( racct.acct.has_rex_balance(), "account has no REX balance" );
+      check( rex.amount > 0 && rex.symbol == racct.acct.rex_balance.symbol, "asset must be a positive amount of (REX, 4)" );
+      const asset rex_in_sell_order = update_rex_account( owner, asset( 0, core_symbol() ), asset( 0, core_symbol() ) );
+      auto& rb = racct.acct;
+      check( rex.amount + rex_in_sell_order.amount + rb.savings_rex <= rb.rex_balance.amount,
              "insufficient REX balance" );
-      process_rex_maturities( bitr );
-      _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
+      process_rex_maturities( racct );
+      {
          int64_t moved_rex = 0;
-         while ( !rb.rex_maturities.empty() && moved_rex < rex.amount) {
-            const int64_t drex = std::min( rex.amount - moved_rex, rb.rex_maturities.back().second );
-            rb.rex_maturities.back().second -= drex;
-            moved_rex                       += drex;
-            if ( rb.rex_maturities.back().second == 0 ) {
-               rb.rex_maturities.pop_back();
-            }
+         for ( uint32_t day = rb.matured_day + rex_account_info::maturity_slots; day > rb.matured_day && moved_rex < rex.amount; --day ) {
+            const int64_t drex = std::min( rex.amount - moved_rex, rb.maturing_on( day ) );
+            rb.maturing_on( day ) -= drex;
+            moved_rex             += drex;
          }
          if ( moved_rex < rex.amount ) {
             const int64_t drex = rex.amount - moved_rex;
@@ -289,8 +356,9 @@ namespace eosiosystem {
             check( rex_in_sell_order.amount <= rb.matured_rex, "logic error in mvtosavings" );
          }
          check( moved_rex == rex.amount, "programmer error in mvtosavings" );
-      });
-      put_rex_savings( bitr, rex_in_savings + rex.amount );
+         rb.savings_rex     += rex.amount;
+         racct.balance_dirty = true;
+      }
    }
 
    void system_contract::mvfrsavings( const name& owner, const asset& rex )
@@ -299,20 +367,13 @@ namespace eosiosystem {
 
       runrex(2);
 
-      auto bitr = _rexbalance.require_find( owner.value, "account has no REX balance" );
-      check( rex.amount > 0 && rex.symbol == bitr->rex_balance.symbol, "asset must be a positive amount of (REX, 4)" );
-      const int64_t rex_in_savings = read_rex_savings( bitr );
-      check( rex.amount <= rex_in_savings, "insufficient REX in savings" );
-      process_rex_maturities( bitr );
-      _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-         const time_point_sec maturity = get_rex_maturity();
-         if ( !rb.rex_maturities.empty() && rb.rex_maturities.back().first == maturity ) {
-            rb.rex_maturities.back().second += rex.amount;
-         } else {
-            rb.rex_maturities.emplace_back( maturity, rex.amount );
-         }
-      });
-      put_rex_savings( bitr, rex_in_savings - rex.amount );
+      auto& racct = get_rex_account( owner );
+      check( racct.acct.has_rex_balance(), "account has no REX balance" );
+      check( rex.amount > 0 && rex.symbol == racct.acct.rex_balance.symbol, "asset must be a positive amount of (REX, 4)" );
+      check( rex.amount <= racct.acct.savings_rex, "insufficient REX in savings" );
+      process_rex_maturities( racct );
+      racct.acct.savings_rex -= rex.amount;
+      add_maturing_rex( racct, rex.amount );
       update_rex_account( owner, asset( 0, core_symbol() ), asset( 0, core_symbol() ) );
    }
 
@@ -335,24 +396,42 @@ namespace eosiosystem {
          auto net_idx = net_loans.get_index<"byowner"_n>();
          bool no_outstanding_net_loans = ( net_idx.find( owner.value ) == net_idx.end() );
 
-         auto fund_itr = _rexfunds.find( owner.value );
-         bool no_outstanding_rex_fund = ( fund_itr != _rexfunds.end() ) && ( fund_itr->balance.amount == 0 );
+         auto& racct = get_rex_account( owner );
+         bool no_outstanding_rex_fund = racct.acct.has_fund() && ( racct.acct.fund.amount == 0 );
 
          if ( no_outstanding_cpu_loans && no_outstanding_net_loans && no_outstanding_rex_fund ) {
-            _rexfunds.erase( fund_itr );
+            racct.acct.fund  = asset();
+            racct.fund_dirty = true;
          }
       }
 
       /// check for remaining rex balance
       {
-         auto rex_itr = _rexbalance.find( owner.value );
-         if ( rex_itr != _rexbalance.end() ) {
-            check( rex_itr->rex_balance.amount == 0, "account has remaining REX balance, must sell first");
-            _rexbalance.erase( rex_itr );
+         auto& racct = get_rex_account( owner );
+         if ( racct.acct.has_rex_balance() ) {
+            check( racct.acct.rex_balance.amount == 0, "account has remaining REX balance, must sell first");
+            racct.acct.vote_stake  = asset();
+            racct.acct.rex_balance = asset();
+            racct.acct.matured_rex = 0;
+            racct.acct.matured_day = 0;
+            racct.acct.maturing_rex.assign( rex_account_info::maturity_slots, 0 );
+            racct.acct.savings_rex = 0;
+            racct.balance_dirty    = true;
          }
       }
    }
 
+   void system_contract::migraterex( const name& owner )
+   {
+      require_auth( owner );
+
+      auto& racct = get_rex_account( owner );
+      check( !racct.in_account_table, "REX account has already been migrated" );
+      check( racct.acct.has_fund() || racct.acct.has_rex_balance(), "account has no REX fund or REX balance" );
+      racct.fund_dirty    = true;
+      racct.balance_dirty = true;
+   }
+
    /**
     * @brief Updates account NET and CPU resource limits
     *
@@ -397,9 +476,9 @@ namespace eosiosystem {
 
          if( !(net_managed && cpu_managed) ) {
             int64_t ram_bytes = 0, net = 0, cpu = 0;
-            get_resource_limits( receiver, ram_bytes, net, cpu );
+            get_account_limits( receiver, ram_bytes, net, cpu );
 
-            set_resource_limits( receiver,
+            set_account_limits( receiver,
                                  ram_bytes,
                                  net_managed ? net : tot_itr->net_weight.amount,
                                  cpu_managed ? cpu : tot_itr->cpu_weight.amount );
@@ -509,6 +588,25 @@ namespace eosiosystem {
     * @param max - maximum number of each of the three categories to be processed
     */
    void system_contract::runrex( uint16_t max )
+   {
+      begin_rex_maintenance();
+
+      process_expired_rex_loans( max );
+
+      /// process sellrex orders
+      for ( const auto& fill : fill_rex_orders( max ) ) {
+         /// send dummy action to show owner and proceeds of filled sellrex order
+         rex_results::orderresult_action order_act( rex_account, std::vector<eosio::permission_level>{ } );
+         order_act.send( fill.first, fill.second );
+      }
+   }
+
+   /**
+    * @brief Brings REX pool up to date before loans and sellrex orders are processed
+    *
+    * Adds accrued returns from the REX return pool and transfers pending name bid proceeds.
+    */
+   void system_contract::begin_rex_maintenance()
    {
       check( rex_system_initialized(), "rex system not initialized yet" );
 
@@ -516,36 +614,6 @@ namespace eosiosystem {
 
       const auto& pool = _rexpool.begin();
 
-      auto process_expired_loan = [&]( auto& idx, const auto& itr ) -> std::pair<bool, int64_t> {
-         /// update rex_pool in order to delete existing loan
-         remove_loan_from_rex_pool( *itr );
-         bool    delete_loan   = false;
-         int64_t delta_stake   = 0;
-         /// calculate rented tokens at current price
-         int64_t rented_tokens = exchange_state::get_bancor_output( pool->total_rent.amount,
-                                                                    pool->total_unlent.amount,
-                                                                    itr->payment.amount );
-         /// conditions for loan renewal
-         bool renew_loan = itr->payment <= itr->balance        /// loan has sufficient balance
-                        && itr->payment.amount < rented_tokens /// loan has favorable return
-                        && rex_loans_available();              /// no pending sell orders
-         if ( renew_loan ) {
-            /// update rex_pool in order to account for renewed loan
-            add_loan_to_rex_pool( itr->payment, rented_tokens, false );
-            /// update renewed loan fields
-            delta_stake = update_renewed_loan( idx, itr, rented_tokens );
-         } else {
-            delete_loan = true;
-            delta_stake = -( itr->total_staked.amount );
-            /// refund "from" account if the closed loan balance is positive
-            if ( itr->balance.amount > 0 ) {
-               transfer_to_fund( itr->from, itr->balance );
-            }
-         }
-
-         return { delete_loan, delta_stake };
-      };
-
       /// transfer from eosio.names to eosio.rex
       if ( pool->namebid_proceeds.amount > 0 ) {
          channel_to_rex( names_account, pool->namebid_proceeds );
@@ -553,68 +621,161 @@ namespace eosiosystem {
             rt.namebid_proceeds.amount = 0;
          });
       }
+   }
 
-      /// process cpu loans
-      {
-         rex_cpu_loan_table cpu_loans( get_self(), get_self().value );
-         auto cpu_idx = cpu_loans.get_index<"byexpr"_n>();
-         for ( uint16_t i = 0; i < max; ++i ) {
-            auto itr = cpu_idx.begin();
-            if ( itr == cpu_idx.end() || itr->expiration > current_time_point() ) break;
+   /**
+    * @brief Closes or renews expired NET and CPU loans
+    *
+    * @param max - maximum number of each of CPU and NET loans to be processed
+    */
+   void system_contract::process_expired_rex_loans( uint16_t max )
+   {
+      process_expired_loans<rex_cpu_loan_table>( true, max );
+      process_expired_loans<rex_net_loan_table>( false, max );
+   }
 
-            auto result = process_expired_loan( cpu_idx, itr );
-            if ( result.second != 0 )
-               update_resource_limits( itr->from, itr->receiver, 0, result.second );
+   /**
+    * @brief Closes or renews expired loans of one kind, oldest first
+    *
+    * @param cpu - true for CPU loans, false for NET loans
+    * @param max - maximum number of loans to be processed
+    *
+    * @return uint32_t - number of loans processed
+    */
+   template <typename T>
+   uint32_t system_contract::process_expired_loans( bool cpu, uint32_t max )
+   {
+      T loans( get_self(), get_self().value );
+      auto idx = loans.template get_index<"byexpr"_n>();
+      uint32_t processed = 0;
+      for ( ; processed < max; ++processed ) {
+         auto itr = idx.begin();
+         if ( itr == idx.end() || itr->expiration > current_time_point() ) break;
+
+         auto result = process_expired_loan( idx, itr );
+         if ( result.second != 0 )
+            update_resource_limits( itr->from, itr->receiver, cpu ? 0 : result.second, cpu ? result.second : 0 );
+
+         if ( result.first )
+            idx.erase( itr );
+      }
+      return processed;
+   }
 
-            if ( result.first )
-               cpu_idx.erase( itr );
+   /**
+    * @brief Renews an expired loan if it is funded and favorable, otherwise marks it for deletion
+    *
+    * @return std::pair<bool, int64_t> - whether the loan is to be deleted, and change in its staked tokens
+    */
+   template <typename Index, typename Iterator>
+   std::pair<bool, int64_t> system_contract::process_expired_loan( Index& idx, const Iterator& itr )
+   {
+      const auto& pool = _rexpool.begin();
+      /// update rex_pool in order to delete existing loan
+      remove_loan_from_rex_pool( *itr );
+      bool    delete_loan   = false;
+      int64_t delta_stake   = 0;
+      /// calculate rented tokens at current price
+      int64_t rented_tokens = exchange_state::get_bancor_output( pool->total_rent.amount,
+                                                                 pool->total_unlent.amount,
+                                                                 itr->payment.amount );
+      /// conditions for loan renewal
+      bool renew_loan = itr->payment <= itr->balance        /// loan has sufficient balance
+                     && itr->payment.amount < rented_tokens /// loan has favorable return
+                     && rex_loans_available();              /// no pending sell orders
+      if ( renew_loan ) {
+         /// update rex_pool in order to account for renewed loan
+         add_loan_to_rex_pool( itr->payment, rented_tokens, false );
+         /// update renewed loan fields
+         delta_stake = update_renewed_loan( idx, itr, rented_tokens );
+      } else {
+         delete_loan = true;
+         delta_stake = -( itr->total_staked.amount );
+         /// refund "from" account if the closed loan balance is positive
+         if ( itr->balance.amount > 0 ) {
+            transfer_to_fund( itr->from, itr->balance );
          }
       }
 
-      /// process net loans
-      {
-         rex_net_loan_table net_loans( get_self(), get_self().value );
-         auto net_idx = net_loans.get_index<"byexpr"_n>();
-         for ( uint16_t i = 0; i < max; ++i ) {
-            auto itr = net_idx.begin();
-            if ( itr == net_idx.end() || itr->expiration > current_time_point() ) break;
+      return { delete_loan, delta_stake };
+   }
 
-            auto result = process_expired_loan( net_idx, itr );
-            if ( result.second != 0 )
-               update_resource_limits( itr->from, itr->receiver, result.second, 0 );
+   /**
+    * @brief Fills queued sellrex orders in time order
+    *
+    * @param max - maximum number of open sellrex orders to be examined
+    *
+    * @return std::vector<std::pair<name, asset>> - owner and proceeds of each filled order
+    */
+   std::vector<std::pair<name, asset>> system_contract::fill_rex_orders( uint16_t max )
+   {
+      uint64_t order_time = 0;
+      uint32_t examined   = 0;
+      return fill_rex_orders( max, order_time, examined );
+   }
 
-            if ( result.first )
-               net_idx.erase( itr );
-         }
+   /**
+    * @brief Fills queued sellrex orders in time order, starting from a given order
+    *
+    * Orders are matched one after another exactly as fill_rex_order would match them, but REX pool
+    * totals are carried locally and the REX pool is modified once after the pass. Matching stops
+    * early once no unlent tokens are left above the lower bound.
+    *
+    * @param max - maximum number of open sellrex orders to be examined
+    * @param order_time - `bytime` key of the first order to examine, 0 for the oldest one; set to the
+    *    key of the next unexamined order, or to 0 if no open order is left to examine
+    * @param examined - set to the number of orders examined
+    *
+    * @return std::vector<std::pair<name, asset>> - owner and proceeds of each filled order
+    */
+   std::vector<std::pair<name, asset>> system_contract::fill_rex_orders( uint32_t max, uint64_t& order_time, uint32_t& examined )
+   {
+      std::vector<std::pair<name, asset>> fills;
+      examined = 0;
+      if ( _rexorders.begin() == _rexorders.end() ) {
+         order_time = 0;
+         return fills;
       }
 
-      /// process sellrex orders
-      if ( _rexorders.begin() != _rexorders.end() ) {
-         auto idx  = _rexorders.get_index<"bytime"_n>();
-         auto oitr = idx.begin();
-         for ( uint16_t i = 0; i < max; ++i ) {
-            if ( oitr == idx.end() || !oitr->is_open ) break;
-            auto next = oitr;
-            ++next;
-            auto bitr = _rexbalance.find( oitr->owner.value );
-            if ( bitr != _rexbalance.end() ) { // should always be true
-               auto result = fill_rex_order( bitr, oitr->rex_requested );
-               if ( result.success ) {
-                  const name order_owner = oitr->owner;
-                  idx.modify( oitr, same_payer, [&]( auto& order ) {
-                     order.proceeds.amount     = result.proceeds.amount;
-                     order.stake_change.amount = result.stake_change.amount;
-                     order.close();
-                  });
-                  /// send dummy action to show owner and proceeds of filled sellrex order
-                  rex_results::orderresult_action order_act( rex_account, std::vector<eosio::permission_level>{ } );
-                  order_act.send( order_owner, result.proceeds );
-               }
+      const auto& pool         = _rexpool.begin();
+      int64_t total_rex        = pool->total_rex.amount;
+      int64_t total_lendable   = pool->total_lendable.amount;
+      const int64_t total_lent = pool->total_lent.amount;
+
+      auto idx  = _rexorders.get_index<"bytime"_n>();
+      auto oitr = idx.lower_bound( order_time );
+      order_time = 0;
+      for ( ; examined < max; ++examined ) {
+         if ( oitr == idx.end() || !oitr->is_open ) break;
+         if ( total_rex <= 0 || total_lendable - total_lent < total_lent / 10 ) break;
+         auto next = oitr;
+         ++next;
+         auto& racct = get_rex_account( oitr->owner );
+         if ( racct.acct.has_rex_balance() ) { // should always be true
+            auto result = fill_rex_order( racct, oitr->rex_requested, total_rex, total_lendable, total_lent );
+            if ( result.success ) {
+               fills.emplace_back( oitr->owner, result.proceeds );
+               idx.modify( oitr, same_payer, [&]( auto& order ) {
+                  order.proceeds.amount     = result.proceeds.amount;
+                  order.stake_change.amount = result.stake_change.amount;
+                  order.close();
+               });
             }
-            oitr = next;
          }
+         oitr = next;
+      }
+      if ( examined == max && oitr != idx.end() && oitr->is_open ) {
+         order_time = oitr->by_time();
       }
 
+      if ( !fills.empty() ) {
+         _rexpool.modify( pool, same_payer, [&]( auto& rt ) {
+            rt.total_rex.amount      = total_rex;
+            rt.total_lendable.amount = total_lendable;
+            rt.total_unlent.amount   = rt.total_lendable.amount - rt.total_lent.amount;
+         });
+      }
+      return fills;
    }
 
    /**
@@ -763,17 +924,48 @@ namespace eosiosystem {
     * different function to complete order processing, i.e. transfer proceeds to user REX fund and
     * update user vote weight.
     *
-    * @param bitr - iterator pointing to rex_balance database record
+    * @param racct - owner REX account
     * @param rex - amount of rex to be sold
     *
     * @return rex_order_outcome - a struct containing success flag, order proceeds, and resultant
     * vote stake change
     */
-   rex_order_outcome system_contract::fill_rex_order( const rex_balance_table::const_iterator& bitr, const asset& rex )
+   rex_order_outcome system_contract::fill_rex_order( rex_account_cache& racct, const asset& rex )
    {
       auto rexitr = _rexpool.begin();
-      const int64_t S0 = rexitr->total_lendable.amount;
-      const int64_t R0 = rexitr->total_rex.amount;
+      int64_t total_rex      = rexitr->total_rex.amount;
+      int64_t total_lendable = rexitr->total_lendable.amount;
+      const auto result = fill_rex_order( racct, rex, total_rex, total_lendable, rexitr->total_lent.amount );
+      if ( result.success ) {
+         _rexpool.modify( rexitr, same_payer, [&]( auto& rt ) {
+            rt.total_rex.amount      = total_rex;
+            rt.total_lendable.amount = total_lendable;
+            rt.total_unlent.amount   = rt.total_lendable.amount - rt.total_lent.amount;
+         });
+      }
+      return result;
+   }
+
+   /**
+    * @brief Processes a sellrex order against REX pool totals held by the caller
+    *
+    * Same as fill_rex_order above, except that REX pool totals are read from and written to
+    * the arguments rather than the REX pool table.
+    *
+    * @param racct - owner REX account
+    * @param rex - amount of rex to be sold
+    * @param total_rex - REX pool total_rex, updated if the order is filled
+    * @param total_lendable - REX pool total_lendable, updated if the order is filled
+    * @param total_lent - REX pool total_lent
+    *
+    * @return rex_order_outcome - a struct containing success flag, order proceeds, and resultant
+    * vote stake change
+    */
+   rex_order_outcome system_contract::fill_rex_order( rex_account_cache& racct, const asset& rex,
+                                                      int64_t& total_rex, int64_t& total_lendable, int64_t total_lent )
+   {
+      const int64_t S0 = total_lendable;
+      const int64_t R0 = total_rex;
       const int64_t p  = (uint128_t(rex.amount) * S0) / R0;
       const int64_t R1 = R0 - rex.amount;
       const int64_t S1 = S0 - p;
@@ -781,22 +973,19 @@ namespace eosiosystem {
       asset stake_change( 0, core_symbol() );
       bool  success = false;
 
-      const int64_t unlent_lower_bound = rexitr->total_lent.amount / 10;
-      const int64_t available_unlent   = rexitr->total_unlent.amount - unlent_lower_bound; // available_unlent <= 0 is possible
+      const int64_t unlent_lower_bound = total_lent / 10;
+      const int64_t available_unlent   = ( total_lendable - total_lent ) - unlent_lower_bound; // available_unlent <= 0 is possible
       if ( proceeds.amount <= available_unlent ) {
-         const int64_t init_vote_stake_amount = bitr->vote_stake.amount;
-         const int64_t current_stake_value    = ( uint128_t(bitr->rex_balance.amount) * S0 ) / R0;
-         _rexpool.modify( rexitr, same_payer, [&]( auto& rt ) {
-            rt.total_rex.amount      = R1;
-            rt.total_lendable.amount = S1;
-            rt.total_unlent.amount   = rt.total_lendable.amount - rt.total_lent.amount;
-         });
-         _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-            rb.vote_stake.amount   = current_stake_value - proceeds.amount;
-            rb.rex_balance.amount -= rex.amount;
-            rb.matured_rex        -= rex.amount;
-         });
-         stake_change.amount = bitr->vote_stake.amount - init_vote_stake_amount;
+         auto& rb = racct.acct;
+         const int64_t init_vote_stake_amount = rb.vote_stake.amount;
+         const int64_t current_stake_value    = ( uint128_t(rb.rex_balance.amount) * S0 ) / R0;
+         total_rex      = R1;
+         total_lendable = S1;
+         rb.vote_stake.amount   = current_stake_value - proceeds.amount;
+         rb.rex_balance.amount -= rex.amount;
+         rb.matured_rex        -= rex.amount;
+         racct.balance_dirty    = true;
+         stake_change.amount = rb.vote_stake.amount - init_vote_stake_amount;
          success = true;
       } else {
          proceeds.amount = 0;
@@ -843,11 +1032,11 @@ namespace eosiosystem {
    void system_contract::transfer_from_fund( const name& owner, const asset& amount )
    {
       check( 0 < amount.amount && amount.symbol == core_symbol(), "must transfer positive amount from REX fund" );
-      auto itr = _rexfunds.require_find( owner.value, "must deposit to REX fund first" );
-      check( amount <= itr->balance, "insufficient funds" );
-      _rexfunds.modify( itr, same_payer, [&]( auto& fund ) {
-         fund.balance.amount -= amount.amount;
-      });
+      auto& racct = get_rex_account( owner );
+      check( racct.acct.has_fund(), "must deposit to REX fund first" );
+      check( amount <= racct.acct.fund, "insufficient funds" );
+      racct.acct.fund.amount -= amount.amount;
+      racct.fund_dirty        = true;
    }
 
    /**
@@ -859,17 +1048,13 @@ namespace eosiosystem {
    void system_contract::transfer_to_fund( const name& owner, const asset& amount )
    {
       check( 0 < amount.amount && amount.symbol == core_symbol(), "must transfer positive amount to REX fund" );
-      auto itr = _rexfunds.find( owner.value );
-      if ( itr == _rexfunds.end() ) {
-         _rexfunds.emplace( owner, [&]( auto& fund ) {
-            fund.owner   = owner;
-            fund.balance = amount;
-         });
+      auto& racct = get_rex_account( owner );
+      if ( !racct.acct.has_fund() ) {
+         racct.acct.fund = amount;
       } else {
-         _rexfunds.modify( itr, same_payer, [&]( auto& fund ) {
-            fund.balance.amount += amount.amount;
-         });
+         racct.acct.fund.amount += amount.amount;
       }
+      racct.fund_dirty = true;
    }
 
    /**
@@ -883,11 +1068,13 @@ namespace eosiosystem {
     * @param owner - owner account name
     * @param proceeds - additional proceeds to be transfered to owner REX fund
     * @param delta_stake - additional stake to be added to owner vote weight
-    * @param force_vote_update - if true, vote weight is updated even if vote stake didn't change
+    * @param lazy_vote_update - if true and no sellrex order has been filled, delta_stake is only REX value
+    *                           drift: it is added to owner stake and producer votes are recalculated once
+    *                           the accumulated drift is large enough
     *
     * @return asset - REX amount of owner unfilled sell order if one exists
     */
-   asset system_contract::update_rex_account( const name& owner, const asset& proceeds, const asset& delta_stake, bool force_vote_update )
+   asset system_contract::update_rex_account( const name& owner, const asset& proceeds, const asset& delta_stake, bool lazy_vote_update )
    {
       asset to_fund( proceeds );
       asset to_stake( delta_stake );
@@ -899,18 +1086,79 @@ namespace eosiosystem {
          } else {
             to_fund.amount  += itr->proceeds.amount;
             to_stake.amount += itr->stake_change.amount;
+            lazy_vote_update = false;
             _rexorders.erase( itr );
          }
       }
 
       if ( to_fund.amount > 0 )
          transfer_to_fund( owner, to_fund );
-      if ( force_vote_update || to_stake.amount != 0 )
+      if ( lazy_vote_update )
+         update_rex_vote_stake( owner, to_stake );
+      else if ( to_stake.amount != 0 )
          update_voting_power( owner, to_stake );
 
       return rex_in_sell_order;
    }
 
+   /**
+    * @brief Adds REX value drift to owner stake and queues owner votes for recalculation
+    *
+    * If owner votes for producers or a proxy, the drift is accumulated in owner `unsynced_rex_stake`
+    * instead of recalculating its votes. Once the accumulated drift reaches 1/`rex_vote_sync_divisor`
+    * of owner stake, owner is added to the `rexvotesync` queue, paid for by the system contract, which
+    * is drained by `onblock` and `syncrexvotes`. Any vote recalculation of owner settles the drift.
+    *
+    * @param owner - owner account name
+    * @param delta_stake - change in owner REX vote stake
+    */
+   void system_contract::update_rex_vote_stake( const name& owner, const asset& delta_stake )
+   {
+      auto vitr = _voters.find( owner.value );
+      if ( vitr == _voters.end() || ( vitr->producers.empty() && !vitr->proxy ) ) {
+         update_voting_power( owner, delta_stake );
+         return;
+      }
+
+      update_voting_power( owner, delta_stake, false );
+      _voters.modify( vitr, same_payer, [&]( auto& v ) {
+         v.unsynced_rex_stake.amount += delta_stake.amount;
+      });
+
+      const int64_t drift = std::abs( vitr->unsynced_rex_stake.amount );
+      if ( drift != 0 && drift >= vitr->staked / rex_vote_sync_divisor ) {
+         rex_vote_sync_table vote_sync( get_self(), get_self().value );
+         if ( vote_sync.find( owner.value ) == vote_sync.end() ) {
+            vote_sync.emplace( get_self(), [&]( auto& vs ) {
+               vs.owner = owner;
+            });
+         }
+      }
+   }
+
+   /**
+    * @brief Recalculates votes of up to max voters queued in `rexvotesync`
+    *
+    * @param max - number of queued voters to be processed
+    */
+   void system_contract::sync_rex_votes( uint16_t max )
+   {
+      rex_vote_sync_table vote_sync( get_self(), get_self().value );
+      uint16_t processed = 0;
+      for ( auto itr = vote_sync.begin(); itr != vote_sync.end() && processed < max; ++processed ) {
+         const name owner = itr->owner;
+         itr = vote_sync.erase( itr );
+         auto vitr = _voters.find( owner.value );
+         if ( vitr == _voters.end() ) {
+            continue;
+         }
+         update_rex_stake( owner );
+         if ( vitr->producers.size() || vitr->proxy ) {
+            update_votes( owner, vitr->proxy, vitr->producers, false );
+         }
+      }
+   }
+
    /**
     * @brief Channels system fees to REX pool
     *
@@ -956,7 +1204,7 @@ namespace eosiosystem {
     */
    time_point_sec system_contract::get_rex_maturity()
    {
-      const uint32_t num_of_maturity_buckets = 5;
+      const uint32_t num_of_maturity_buckets = rex_account_info::maturity_slots;
       static const uint32_t now = current_time_point().sec_since_epoch();
       static const uint32_t r   = now % seconds_per_day;
       static const time_point_sec rms{ now - r + num_of_maturity_buckets * seconds_per_day };
@@ -966,41 +1214,57 @@ namespace eosiosystem {
    /**
     * @brief Updates REX owner maturity buckets
     *
-    * @param bitr - iterator pointing to rex_balance object
+    * @param racct - owner REX account
     */
-   void system_contract::process_rex_maturities( const rex_balance_table::const_iterator& bitr )
+   void system_contract::process_rex_maturities( rex_account_cache& racct )
    {
-      const time_point_sec now = current_time_point();
-      _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-         while ( !rb.rex_maturities.empty() && rb.rex_maturities.front().first <= now ) {
-            rb.matured_rex += rb.rex_maturities.front().second;
-            rb.rex_maturities.pop_front();
+      const uint32_t today = current_time_point().sec_since_epoch() / seconds_per_day;
+      auto& rb = racct.acct;
+      if ( rb.matured_day < today ) {
+         const uint32_t last_day = std::min( today, rb.matured_day + rex_account_info::maturity_slots );
+         for ( uint32_t day = rb.matured_day + 1; day <= last_day; ++day ) {
+            rb.matured_rex       += rb.maturing_on( day );
+            rb.maturing_on( day ) = 0;
          }
-      });
+         rb.matured_day      = today;
+         racct.balance_dirty = true;
+      }
+   }
+
+   /**
+    * @brief Adds REX to owner maturity bucket of REX bought in the current action
+    *
+    * Owner maturities must have been processed in the current action.
+    *
+    * @param racct - owner REX account
+    * @param rex - amount of REX to be added
+    */
+   void system_contract::add_maturing_rex( rex_account_cache& racct, int64_t rex )
+   {
+      racct.acct.maturing_on( get_rex_maturity().sec_since_epoch() / seconds_per_day ) += rex;
+      racct.balance_dirty = true;
    }
 
    /**
     * @brief Consolidates REX maturity buckets into one
     *
-    * @param bitr - iterator pointing to rex_balance object
+    * @param racct - owner REX account
     * @param rex_in_sell_order - REX tokens in owner unfilled sell order, if one exists
     */
-   void system_contract::consolidate_rex_balance( const rex_balance_table::const_iterator& bitr,
-                                                  const asset& rex_in_sell_order )
+   void system_contract::consolidate_rex_balance( rex_account_cache& racct, const asset& rex_in_sell_order )
    {
-      const int64_t rex_in_savings = read_rex_savings( bitr );
-      _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-         int64_t total  = rb.matured_rex - rex_in_sell_order.amount;
-         rb.matured_rex = rex_in_sell_order.amount;
-         while ( !rb.rex_maturities.empty() ) {
-            total += rb.rex_maturities.front().second;
-            rb.rex_maturities.pop_front();
-         }
-         if ( total > 0 ) {
-            rb.rex_maturities.emplace_back( get_rex_maturity(), total );
-         }
-      });
-      put_rex_savings( bitr, rex_in_savings );
+      auto& rb = racct.acct;
+      int64_t total  = rb.matured_rex - rex_in_sell_order.amount;
+      rb.matured_rex = rex_in_sell_order.amount;
+      for ( auto& rex : rb.maturing_rex ) {
+         total += rex;
+         rex    = 0;
+      }
+      rb.matured_day      = current_time_point().sec_since_epoch() / seconds_per_day;
+      racct.balance_dirty = true;
+      if ( total > 0 ) {
+         add_maturing_rex( racct, total );
+      }
    }
 
    /**
@@ -1112,109 +1376,148 @@ namespace eosiosystem {
    {
       asset init_rex_stake( 0, core_symbol() );
       asset current_rex_stake( 0, core_symbol() );
-      auto bitr = _rexbalance.find( owner.value );
-      if ( bitr == _rexbalance.end() ) {
-         bitr = _rexbalance.emplace( owner, [&]( auto& rb ) {
-            rb.owner       = owner;
-            rb.vote_stake  = payment;
-            rb.rex_balance = rex_received;
-         });
+      auto& racct = get_rex_account( owner );
+      auto& rb    = racct.acct;
+      if ( !rb.has_rex_balance() ) {
+         rb.vote_stake  = payment;
+         rb.rex_balance = rex_received;
          current_rex_stake.amount = payment.amount;
       } else {
-         init_rex_stake.amount = bitr->vote_stake.amount;
-         _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-            rb.rex_balance.amount += rex_received.amount;
-            rb.vote_stake.amount   = ( uint128_t(rb.rex_balance.amount) * _rexpool.begin()->total_lendable.amount )
-                                     / _rexpool.begin()->total_rex.amount;
-         });
-         current_rex_stake.amount = bitr->vote_stake.amount;
+         init_rex_stake.amount = rb.vote_stake.amount;
+         rb.rex_balance.amount += rex_received.amount;
+         rb.vote_stake.amount   = ( uint128_t(rb.rex_balance.amount) * _rexpool.begin()->total_lendable.amount )
+                                  / _rexpool.begin()->total_rex.amount;
+         current_rex_stake.amount = rb.vote_stake.amount;
       }
+      racct.balance_dirty = true;
 
-      const int64_t rex_in_savings = read_rex_savings( bitr );
-      process_rex_maturities( bitr );
-      _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-         const time_point_sec maturity = get_rex_maturity();
-         if ( !rb.rex_maturities.empty() && rb.rex_maturities.back().first == maturity ) {
-            rb.rex_maturities.back().second += rex_received.amount;
-         } else {
-            rb.rex_maturities.emplace_back( maturity, rex_received.amount );
-         }
-      });
-      put_rex_savings( bitr, rex_in_savings );
+      process_rex_maturities( racct );
+      add_maturing_rex( racct, rex_received.amount );
       return current_rex_stake - init_rex_stake;
    }
 
    /**
-    * @brief Reads amount of REX in savings bucket and removes the bucket from maturities
-    *
-    * Reads and (temporarily) removes REX savings bucket from REX maturities in order to
-    * allow uniform processing of remaining buckets as savings is a special case. This
-    * function is used in conjunction with put_rex_savings.
-    *
-    * @param bitr - iterator pointing to rex_balance object
+    * @brief Updates voter REX vote stake to the current value of REX tokens held
     *
-    * @return int64_t - amount of REX in savings bucket
+    * @param voter - account name of voter
     */
-   int64_t system_contract::read_rex_savings( const rex_balance_table::const_iterator& bitr )
+   void system_contract::update_rex_stake( const name& voter )
    {
-      int64_t rex_in_savings = 0;
-      static const time_point_sec end_of_days = time_point_sec::maximum();
-      if ( !bitr->rex_maturities.empty() && bitr->rex_maturities.back().first == end_of_days ) {
-         _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-            rex_in_savings = rb.rex_maturities.back().second;
-            rb.rex_maturities.pop_back();
-         });
+      int64_t delta_stake = 0;
+      auto& racct = get_rex_account( voter );
+      if ( racct.acct.has_rex_balance() && rex_available() ) {
+         asset init_vote_stake = racct.acct.vote_stake;
+         asset current_vote_stake( 0, core_symbol() );
+         current_vote_stake.amount = ( uint128_t(racct.acct.rex_balance.amount) * _rexpool.begin()->total_lendable.amount )
+                                     / _rexpool.begin()->total_rex.amount;
+         delta_stake = current_vote_stake.amount - init_vote_stake.amount;
+         if ( delta_stake != 0 ) {
+            racct.acct.vote_stake.amount = current_vote_stake.amount;
+            racct.balance_dirty          = true;
+         }
+      }
+
+      if ( delta_stake != 0 ) {
+         auto vitr = _voters.find( voter.value );
+         if ( vitr != _voters.end() ) {
+            _voters.modify( vitr, same_payer, [&]( auto& vinfo ) {
+               vinfo.staked += delta_stake;
+            });
+         }
       }
-      return rex_in_savings;
    }
 
    /**
-    * @brief Adds a specified REX amount to savings bucket
+    * @brief Returns owner REX fund and balance, loading them on first access in the current action
     *
-    * @param bitr - iterator pointing to rex_balance object
-    * @param rex - amount of REX to be added
+    * Legacy `rexfund` and `rexbal` entries are only looked up when the owner has no `rexaccount`
+    * entry. Changes are kept in memory and written back by flush_rex_accounts(), which moves legacy
+    * entries into `rexaccount`.
+    *
+    * @param owner - account name of REX owner
+    *
+    * @return rex_account_cache& - owner REX account, with empty fund and balance if none exist
     */
-   void system_contract::put_rex_savings( const rex_balance_table::const_iterator& bitr, int64_t rex )
+   rex_account_cache& system_contract::get_rex_account( const name& owner )
    {
-      if ( rex == 0 ) return;
-      static const time_point_sec end_of_days = time_point_sec::maximum();
-      _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-         if ( !rb.rex_maturities.empty() && rb.rex_maturities.back().first == end_of_days ) {
-            rb.rex_maturities.back().second += rex;
-         } else {
-            rb.rex_maturities.emplace_back( end_of_days, rex );
+      auto cached = _rexaccounts_cache.find( owner );
+      if ( cached != _rexaccounts_cache.end() ) {
+         return cached->second;
+      }
+
+      auto& racct = _rexaccounts_cache[owner];
+      auto aitr = _rexaccounts.find( owner.value );
+      if ( aitr != _rexaccounts.end() ) {
+         racct.acct             = *aitr;
+         racct.in_account_table = true;
+         return racct;
+      }
+
+      racct.acct.owner = owner;
+      auto fitr = _rexfunds.find( owner.value );
+      if ( fitr != _rexfunds.end() ) {
+         racct.acct.fund     = fitr->balance;
+         racct.in_fund_table = true;
+      }
+      auto bitr = _rexbalance.find( owner.value );
+      if ( bitr != _rexbalance.end() ) {
+         racct.acct.vote_stake     = bitr->vote_stake;
+         racct.acct.rex_balance    = bitr->rex_balance;
+         racct.acct.matured_rex    = bitr->matured_rex;
+         racct.acct.matured_day    = current_time_point().sec_since_epoch() / seconds_per_day;
+         for ( const auto& [maturity, rex] : bitr->rex_maturities ) {
+            const uint32_t day = maturity.sec_since_epoch() / seconds_per_day;
+            if ( maturity == time_point_sec::maximum() ) {
+               racct.acct.savings_rex += rex;
+            } else if ( day <= racct.acct.matured_day ) {
+               racct.acct.matured_rex += rex;
+            } else {
+               racct.acct.maturing_on( day ) += rex;
+            }
          }
-      });
+         racct.in_balance_table    = true;
+      }
+      return racct;
    }
 
    /**
-    * @brief Updates voter REX vote stake to the current value of REX tokens held
+    * @brief Writes modified REX accounts back to the REX account table
     *
-    * @param voter - account name of voter
+    * Every modified owner is written as a single `rexaccount` entry, and the legacy `rexfund` and
+    * `rexbal` entries it was loaded from are removed, so later actions read one row. An owner without
+    * a fund or a balance has its entries erased.
     */
-   void system_contract::update_rex_stake( const name& voter )
+   void system_contract::flush_rex_accounts()
    {
-      int64_t delta_stake = 0;
-      auto bitr = _rexbalance.find( voter.value );
-      if ( bitr != _rexbalance.end() && rex_available() ) {
-         asset init_vote_stake = bitr->vote_stake;
-         asset current_vote_stake( 0, core_symbol() );
-         current_vote_stake.amount = ( uint128_t(bitr->rex_balance.amount) * _rexpool.begin()->total_lendable.amount )
-                                     / _rexpool.begin()->total_rex.amount;
-         _rexbalance.modify( bitr, same_payer, [&]( auto& rb ) {
-            rb.vote_stake.amount = current_vote_stake.amount;
-         });
-         delta_stake = current_vote_stake.amount - init_vote_stake.amount;
-      }
+      for ( const auto& [owner, racct] : _rexaccounts_cache ) {
+         if ( !racct.fund_dirty && !racct.balance_dirty ) {
+            continue;
+         }
+         const auto& acct = racct.acct;
 
-      if ( delta_stake != 0 ) {
-         auto vitr = _voters.find( voter.value );
-         if ( vitr != _voters.end() ) {
-            _voters.modify( vitr, same_payer, [&]( auto& vinfo ) {
-               vinfo.staked += delta_stake;
+         if ( racct.in_fund_table ) {
+            _rexfunds.erase( _rexfunds.get( owner.value ) );
+         }
+         if ( racct.in_balance_table ) {
+            _rexbalance.erase( _rexbalance.get( owner.value ) );
+         }
+         const bool keep = acct.has_fund() || acct.has_rex_balance();
+         if ( racct.in_account_table ) {
+            const auto& row = _rexaccounts.get( owner.value );
+            if ( keep ) {
+               _rexaccounts.modify( row, same_payer, [&]( auto& ra ) {
+                  ra = acct;
+               });
+            } else {
+               _rexaccounts.erase( row );
+            }
+         } else if ( keep ) {
+            _rexaccounts.emplace( owner, [&]( auto& ra ) {
+               ra = acct;
             });
          }
       }
+      _rexaccounts_cache.clear();
    }
 
 }; /// namespace eosiosystem
@@ -225,8 +225,8 @@ namespace eosiosystem {
       require_auth( voter_name );
       vote_stake_updater( voter_name );
       update_votes( voter_name, proxy, producers, true );
-      auto rex_itr = _rexbalance.find( voter_name.value );
-      if( rex_itr != _rexbalance.end() && rex_itr->rex_balance.amount > 0 ) {
+      const auto& racct = get_rex_account( voter_name );
+      if( racct.acct.has_rex_balance() && racct.acct.rex_balance.amount > 0 ) {
          check_voting_requirement( voter_name, "voter holding REX tokens must vote for at least 21 producers or for a proxy" );
       }
    }
@@ -353,10 +353,19 @@ namespace eosiosystem {
 
       update_total_votepay_share( ct, -total_inactive_vpay_share, delta_change_rate );
 
+      if( voter->unsynced_rex_stake.amount != 0 ) {
+         rex_vote_sync_table vote_sync( get_self(), get_self().value );
+         auto sitr = vote_sync.find( voter_name.value );
+         if( sitr != vote_sync.end() ) {
+            vote_sync.erase( sitr );
+         }
+      }
+
       _voters.modify( voter, same_payer, [&]( auto& av ) {
          av.last_vote_weight = new_vote_weight;
          av.producers = producers;
          av.proxy     = proxy;
+         av.unsynced_rex_stake.amount = 0;
       });
    }
 
@@ -168,6 +168,10 @@ struct powerup_tester : eosio_system_tester {
       return push_action(user, "powerupexec"_n, mvo()("user", user)("max", max));
    }
 
+   action_result powerupexec2(name user, uint32_t budget) {
+      return push_action(user, "powerupexec2"_n, mvo()("user", user)("budget", budget));
+   }
+
    action_result powerup(const name& payer, const name& receiver, uint32_t days, int64_t net_frac, int64_t cpu_frac,
                         const asset& max_payment) {
       return push_action(payer, "powerup"_n,
@@ -175,6 +179,45 @@ struct powerup_tester : eosio_system_tester {
                                "cpu_frac", cpu_frac)("max_payment", max_payment));
    }
 
+   action_result powerupmany(const name& payer, const std::vector<std::tuple<name, int64_t, int64_t>>& receivers,
+                             uint32_t days, const asset& max_payment) {
+      std::vector<mvo> rs;
+      for (const auto& [receiver, net_frac, cpu_frac] : receivers)
+         rs.push_back(mvo()("receiver", receiver)("net_frac", net_frac)("cpu_frac", cpu_frac));
+      return push_action(payer, "powerupmany"_n,
+                         mvo()("payer", payer)("receivers", rs)("days", days)("max_payment", max_payment));
+   }
+
+   fc::variant powerupquote(uint32_t days, int64_t net_frac, int64_t cpu_frac) {
+      auto trace = base_tester::push_action(config::system_account_name, "powerupquote"_n, "aaaaaaaaaaaa"_n,
+                                            mvo()("days", days)("net_frac", net_frac)("cpu_frac", cpu_frac));
+      return abi_ser.binary_to_variant("powerup_quote", trace->action_traces[0].return_value,
+                                       abi_serializer::create_yield_function(abi_serializer_max_time));
+   }
+
+   action_result powupsub(const name& payer, const name& receiver, int64_t net_frac, int64_t cpu_frac,
+                          const asset& max_fee, const asset& deposit) {
+      return push_action(payer, "powupsub"_n,
+                         mvo()("payer", payer)("receiver", receiver)("net_frac", net_frac)("cpu_frac", cpu_frac)(
+                               "max_fee", max_fee)("deposit", deposit));
+   }
+
+   action_result powupunsub(const name& payer, const name& receiver) {
+      return push_action(payer, "powupunsub"_n, mvo()("payer", payer)("receiver", receiver));
+   }
+
+   fc::variant get_subscription(const name& receiver) {
+      vector<char> data = get_row_by_account(config::system_account_name, {}, "powup.sub"_n, receiver);
+      return data.empty() ? fc::variant()
+                          : abi_ser.binary_to_variant("powerup_subscription", data,
+                                                      abi_serializer::create_yield_function(abi_serializer_max_time));
+   }
+
+   fc::variant get_history() {
+      vector<char> data = get_row_by_account(config::system_account_name, {}, "powup.hist"_n, "powup.hist"_n);
+      return abi_ser.binary_to_variant("powerup_history", data, abi_serializer::create_yield_function(abi_serializer_max_time));
+   }
+
    powerup_state get_state() {
       vector<char> data = get_row_by_account(config::system_account_name, {}, "powup.state"_n, "powup.state"_n);
       return fc::raw::unpack<powerup_state>(data);
@@ -252,6 +295,38 @@ bool near(A a, B b, D delta) {
    return false;
 }
 
+// Fee of powering up utilization_increase with std::pow, which the contract uses for non-integer exponents
+int64_t generic_powerup_fee(const powerup_state_resource& state, int64_t utilization_increase) {
+   if (utilization_increase <= 0)
+      return 0;
+
+   auto price_integral_delta = [&state](int64_t start_utilization, int64_t end_utilization) -> double {
+      double coefficient = (state.max_price.get_amount() - state.min_price.get_amount()) / state.exponent;
+      double start_u     = double(start_utilization) / state.weight;
+      double end_u       = double(end_utilization) / state.weight;
+      return state.min_price.get_amount() * end_u - state.min_price.get_amount() * start_u +
+             coefficient * std::pow(end_u, state.exponent) - coefficient * std::pow(start_u, state.exponent);
+   };
+   auto price_function = [&state](int64_t utilization) -> double {
+      if (state.exponent - 1.0 <= 0.0)
+         return state.max_price.get_amount();
+      return state.min_price.get_amount() + (state.max_price.get_amount() - state.min_price.get_amount()) *
+                                                  std::pow(double(utilization) / state.weight, state.exponent - 1.0);
+   };
+
+   double  fee               = 0.0;
+   int64_t start_utilization = state.utilization;
+   int64_t end_utilization   = start_utilization + utilization_increase;
+   if (start_utilization < state.adjusted_utilization) {
+      fee += price_function(state.adjusted_utilization) *
+             std::min(utilization_increase, state.adjusted_utilization - start_utilization) / state.weight;
+      start_utilization = state.adjusted_utilization;
+   }
+   if (start_utilization < end_utilization)
+      fee += price_integral_delta(start_utilization, end_utilization);
+   return std::ceil(fee);
+}
+
 BOOST_AUTO_TEST_SUITE(eosio_system_powerup_tests)
 
 BOOST_FIXTURE_TEST_CASE(config_tests, powerup_tester) try {
@@ -852,7 +927,301 @@ BOOST_AUTO_TEST_CASE(rent_tests) try {
             near(t.get_state().cpu.adjusted_utilization, int64_t(.2 * cpu_weight * exp(-2) + .2 * cpu_weight), 0));
    }
 
+
+   {
+      powerup_tester t;
+      init(t, true);
+
+      // 1%, 1% three times; the first two orders expire in the same second and share a bucket entry
+      t.transfer(config::system_account_name, "aaaaaaaaaaaa"_n, core_sym::from_string("3000.0000"));
+      const auto& rlm             = t.control->get_resource_limits_manager();
+      const auto  payer_ram_usage = rlm.get_account_ram_usage("aaaaaaaaaaaa"_n);
+      for (int i = 0; i < 3; ++i) {
+         if (i == 1)
+            // the payer is billed for its bucket row
+            BOOST_REQUIRE(payer_ram_usage < rlm.get_account_ram_usage("aaaaaaaaaaaa"_n));
+         if (i == 2)
+            t.produce_blocks(2);
+         // distinct max_payment keeps the transactions from being duplicates
+         BOOST_REQUIRE_EQUAL("", t.powerup("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, 30, powerup_frac / 100, powerup_frac / 100,
+                                           asset::from_string(i == 1 ? "2999.0000 TST" : "3000.0000 TST")));
+      }
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, 3 * (net_weight / 100));
+      BOOST_REQUIRE_EQUAL(t.get_state().cpu.utilization, 3 * (cpu_weight / 100));
+
+      // each expired bucket entry costs 3 work units
+      t.produce_block(fc::days(30));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec2(config::system_account_name, 2));
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, 3 * (net_weight / 100));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec2(config::system_account_name, 5));
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, net_weight / 100);
+      BOOST_REQUIRE_EQUAL(t.get_state().cpu.utilization, cpu_weight / 100);
+      BOOST_REQUIRE_EQUAL("", t.powerupexec2(config::system_account_name, 3));
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, 0);
+      BOOST_REQUIRE_EQUAL(t.get_state().cpu.utilization, 0);
+   }
+
+   {
+      // a batch costs the same as the same powerups one after the other
+      powerup_tester batched, single;
+      init(batched, true);
+      init(single, true);
+      for (auto* t : { &batched, &single })
+         t->transfer(config::system_account_name, "aaaaaaaaaaaa"_n, core_sym::from_string("3000.0000"));
+
+      BOOST_REQUIRE_EQUAL(batched.wasm_assert_msg("receivers can't be empty"),
+                          batched.powerupmany("aaaaaaaaaaaa"_n, {}, 30, asset::from_string("3000.0000 TST")));
+      BOOST_REQUIRE_EQUAL(batched.wasm_assert_msg("calculated fee is below minimum; try powering up with more resources"),
+                          batched.powerupmany("aaaaaaaaaaaa"_n,
+                                              { { "aaaaaaaaaaaa"_n, powerup_frac / 100, powerup_frac / 100 },
+                                                { "bbbbbbbbbbbb"_n, 0, powerup_frac / 1000000 } },
+                                              30, asset::from_string("3000.0000 TST")));
+
+      auto before_a = batched.get_account_info("aaaaaaaaaaaa"_n);
+      auto before_b = batched.get_account_info("bbbbbbbbbbbb"_n);
+      BOOST_REQUIRE_EQUAL("", batched.powerupmany("aaaaaaaaaaaa"_n,
+                                                  { { "aaaaaaaaaaaa"_n, powerup_frac / 100, powerup_frac / 100 },
+                                                    { "bbbbbbbbbbbb"_n, powerup_frac / 50, powerup_frac / 50 } },
+                                                  30, asset::from_string("3000.0000 TST")));
+      auto after_a = batched.get_account_info("aaaaaaaaaaaa"_n);
+      auto after_b = batched.get_account_info("bbbbbbbbbbbb"_n);
+      BOOST_REQUIRE_EQUAL(after_a.net - before_a.net, net_weight / 100);
+      BOOST_REQUIRE_EQUAL(after_a.cpu - before_a.cpu, cpu_weight / 100);
+      BOOST_REQUIRE_EQUAL(after_b.net - before_b.net, net_weight / 50);
+      BOOST_REQUIRE_EQUAL(after_b.cpu - before_b.cpu, cpu_weight / 50);
+      BOOST_REQUIRE_EQUAL(batched.get_state().net.utilization, 3 * (net_weight / 100));
+
+      auto before_single = single.get_account_info("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE_EQUAL("", single.powerup("aaaaaaaaaaaa"_n, "aaaaaaaaaaaa"_n, 30, powerup_frac / 100, powerup_frac / 100,
+                                             asset::from_string("3000.0000 TST")));
+      BOOST_REQUIRE_EQUAL("", single.powerup("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, 30, powerup_frac / 50, powerup_frac / 50,
+                                             asset::from_string("3000.0000 TST")));
+      BOOST_REQUIRE_EQUAL(before_single.liquid - single.get_account_info("aaaaaaaaaaaa"_n).liquid,
+                          before_a.liquid - after_a.liquid);
+   }
+
+   {
+      powerup_tester t;
+      init(t, true);
+      t.transfer(config::system_account_name, "aaaaaaaaaaaa"_n, core_sym::from_string("3000.0000"));
+      t.produce_block();
+
+      // the quote leaves the market and the global state untouched
+      auto state_before  = t.get_row_by_account(config::system_account_name, {}, "powup.state"_n, "powup.state"_n);
+      auto global_before = t.get_row_by_account(config::system_account_name, config::system_account_name, "global"_n,
+                                                "global"_n);
+      auto quote         = t.powerupquote(30, powerup_frac / 50, powerup_frac / 100);
+      BOOST_REQUIRE(state_before == t.get_row_by_account(config::system_account_name, {}, "powup.state"_n, "powup.state"_n));
+      BOOST_REQUIRE(global_before == t.get_row_by_account(config::system_account_name, config::system_account_name,
+                                                          "global"_n, "global"_n));
+
+      // the quote is exactly what powerup charges in the same block
+      BOOST_REQUIRE_EQUAL(quote["powup_net"].as<int64_t>(), net_weight / 50);
+      BOOST_REQUIRE_EQUAL(quote["powup_cpu"].as<int64_t>(), cpu_weight / 100);
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, 0);
+      t.check_powerup("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, 30, powerup_frac / 50, powerup_frac / 100,
+                      quote["fee"].as<asset>(), net_weight / 50, cpu_weight / 100);
+   }
+
+   {
+      powerup_tester t;
+      init(t, true);
+      t.transfer(config::system_account_name, "aaaaaaaaaaaa"_n, core_sym::from_string("3000.0000"));
+
+      // first sample is taken before the purchase
+      BOOST_REQUIRE_EQUAL("", t.powerup("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, 30, powerup_frac / 100, powerup_frac / 100,
+                                        asset::from_string("3000.0000 TST")));
+      auto hist = t.get_history();
+      BOOST_REQUIRE_EQUAL(1, hist["next"].as<uint32_t>());
+      BOOST_REQUIRE_EQUAL(1, hist["net"].get_array().size());
+      BOOST_REQUIRE_EQUAL(0, hist["net"][size_t(0)]["utilization"].as<int64_t>());
+      BOOST_REQUIRE_EQUAL(0, hist["cpu"][size_t(0)]["price"].as<int64_t>());
+
+      // at most one sample per interval
+      t.produce_block(fc::minutes(10));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      BOOST_REQUIRE_EQUAL(1, t.get_history()["net"].get_array().size());
+
+      t.produce_block(fc::minutes(20));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      hist = t.get_history();
+      BOOST_REQUIRE_EQUAL(2, hist["net"].get_array().size());
+      BOOST_REQUIRE_EQUAL(net_weight / 100, hist["net"][size_t(1)]["utilization"].as<int64_t>());
+      BOOST_REQUIRE_EQUAL(cpu_weight / 100, hist["cpu"][size_t(1)]["utilization"].as<int64_t>());
+      BOOST_REQUIRE_EQUAL(net_weight, hist["net"][size_t(1)]["weight"].as<int64_t>());
+      BOOST_REQUIRE(0 < hist["net"][size_t(1)]["price"].as<int64_t>());
+   }
+
+   {
+      powerup_tester t;
+      init(t, true);
+      t.transfer(config::system_account_name, "aaaaaaaaaaaa"_n, core_sym::from_string("3000.0000"));
+
+      BOOST_REQUIRE_EQUAL(t.wasm_assert_msg("net_frac or cpu_frac must be positive"),
+                          t.powupsub("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, 0, 0, asset::from_string("100.0000 TST"),
+                                     asset::from_string("1000.0000 TST")));
+      BOOST_REQUIRE_EQUAL("", t.powupsub("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, powerup_frac / 100, powerup_frac / 100,
+                                         asset::from_string("100.0000 TST"), asset::from_string("1000.0000 TST")));
+      BOOST_REQUIRE_EQUAL(asset::from_string("2000.0000 TST"), t.get_balance("aaaaaaaaaaaa"_n));
+      BOOST_REQUIRE_EQUAL(t.wasm_assert_msg("receiver is subscribed by another payer"),
+                          t.powupsub("bbbbbbbbbbbb"_n, "bbbbbbbbbbbb"_n, powerup_frac / 100, powerup_frac / 100,
+                                     asset::from_string("100.0000 TST"), asset::from_string("0.0000 TST")));
+
+      // the first period is bought by the next queue processing
+      auto before = t.get_account_info("bbbbbbbbbbbb"_n);
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      auto after = t.get_account_info("bbbbbbbbbbbb"_n);
+      BOOST_REQUIRE_EQUAL(after.net - before.net, net_weight / 100);
+      BOOST_REQUIRE_EQUAL(after.cpu - before.cpu, cpu_weight / 100);
+      auto sub     = t.get_subscription("bbbbbbbbbbbb"_n);
+      auto balance = sub["balance"].as<asset>();
+      BOOST_REQUIRE(balance < asset::from_string("1000.0000 TST"));
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, net_weight / 100);
+
+      // renewed by the pass which releases the previous period
+      t.produce_block(fc::days(29));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      BOOST_REQUIRE_EQUAL(balance, t.get_subscription("bbbbbbbbbbbb"_n)["balance"].as<asset>());
+      t.produce_block(fc::days(1));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      after = t.get_account_info("bbbbbbbbbbbb"_n);
+      BOOST_REQUIRE_EQUAL(after.net - before.net, net_weight / 100);
+      BOOST_REQUIRE_EQUAL(after.cpu - before.cpu, cpu_weight / 100);
+      BOOST_REQUIRE(t.get_subscription("bbbbbbbbbbbb"_n)["balance"].as<asset>() < balance);
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, net_weight / 100);
+
+      // cancelling returns the balance; the current period stays in effect
+      balance = t.get_subscription("bbbbbbbbbbbb"_n)["balance"].as<asset>();
+      BOOST_REQUIRE_EQUAL(t.wasm_assert_msg("receiver is subscribed by another payer"),
+                          t.powupunsub("bbbbbbbbbbbb"_n, "bbbbbbbbbbbb"_n));
+      BOOST_REQUIRE_EQUAL("", t.powupunsub("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n));
+      BOOST_REQUIRE_EQUAL(asset::from_string("2000.0000 TST") + balance, t.get_balance("aaaaaaaaaaaa"_n));
+      BOOST_REQUIRE(t.get_subscription("bbbbbbbbbbbb"_n).is_null());
+      BOOST_REQUIRE_EQUAL(t.get_account_info("bbbbbbbbbbbb"_n).net - before.net, net_weight / 100);
+
+      // a subscription which can't afford a period ends and keeps its balance for the payer to withdraw
+      BOOST_REQUIRE_EQUAL("", t.powupsub("aaaaaaaaaaaa"_n, "aaaaaaaaaaaa"_n, powerup_frac / 100, powerup_frac / 100,
+                                         asset::from_string("0.0001 TST"), asset::from_string("10.0000 TST")));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      sub = t.get_subscription("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE_EQUAL(0, sub["net_frac"].as<int64_t>());
+      BOOST_REQUIRE_EQUAL(0, sub["cpu_frac"].as<int64_t>());
+      BOOST_REQUIRE_EQUAL(asset::from_string("10.0000 TST"), sub["balance"].as<asset>());
+      BOOST_REQUIRE_EQUAL(asset::from_string("1990.0000 TST") + balance, t.get_balance("aaaaaaaaaaaa"_n));
+
+      // an ended subscription is left alone by later passes and resumed by powupsub
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      BOOST_REQUIRE_EQUAL(asset::from_string("10.0000 TST"), t.get_subscription("aaaaaaaaaaaa"_n)["balance"].as<asset>());
+      before = t.get_account_info("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE_EQUAL("", t.powupsub("aaaaaaaaaaaa"_n, "aaaaaaaaaaaa"_n, powerup_frac / 10000, powerup_frac / 10000,
+                                         asset::from_string("10.0000 TST"), asset::from_string("0.0000 TST")));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      after = t.get_account_info("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE_EQUAL(after.net - before.net, net_weight / 10000);
+      balance = t.get_subscription("aaaaaaaaaaaa"_n)["balance"].as<asset>();
+      BOOST_REQUIRE(balance < asset::from_string("10.0000 TST"));
+
+      // the payer withdraws the balance
+      auto liquid = t.get_balance("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE_EQUAL("", t.powupunsub("aaaaaaaaaaaa"_n, "aaaaaaaaaaaa"_n));
+      BOOST_REQUIRE(t.get_subscription("aaaaaaaaaaaa"_n).is_null());
+      BOOST_REQUIRE_EQUAL(liquid + balance, t.get_balance("aaaaaaaaaaaa"_n));
+   }
+
+   {
+      powerup_tester t;
+      init(t, true);
+      t.transfer(config::system_account_name, "aaaaaaaaaaaa"_n, core_sym::from_string("3100000.0000"));
+      BOOST_REQUIRE_EQUAL("", t.powerup("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, 30, powerup_frac, powerup_frac,
+                                        asset::from_string("3000000.0000 TST")));
+
+      // only the keeper actions renew subscriptions
+      BOOST_REQUIRE_EQUAL("", t.powupsub("aaaaaaaaaaaa"_n, "aaaaaaaaaaaa"_n, powerup_frac / 100, powerup_frac / 100,
+                                         asset::from_string("100000.0000 TST"), asset::from_string("100000.0000 TST")));
+      auto before = t.get_account_info("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE_EQUAL(t.wasm_assert_msg("market doesn't have enough resources available"),
+                          t.powerup("aaaaaaaaaaaa"_n, "aaaaaaaaaaaa"_n, 30, powerup_frac / 1000, 0,
+                                    asset::from_string("1000.0000 TST")));
+
+      // a full market leaves the subscription waiting for the next pass
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec2(config::system_account_name, 30));
+      auto sub = t.get_subscription("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE(!sub.is_null());
+      BOOST_REQUIRE_EQUAL(asset::from_string("100000.0000 TST"), sub["balance"].as<asset>());
+      BOOST_REQUIRE_EQUAL(t.get_account_info("aaaaaaaaaaaa"_n).net, before.net);
+
+      // renewed once the full market powerup expires
+      t.produce_block(fc::days(30));
+      BOOST_REQUIRE_EQUAL("", t.powerupexec(config::system_account_name, 10));
+      auto after = t.get_account_info("aaaaaaaaaaaa"_n);
+      BOOST_REQUIRE_EQUAL(after.net - before.net, net_weight / 100);
+      BOOST_REQUIRE_EQUAL(after.cpu - before.cpu, cpu_weight / 100);
+      BOOST_REQUIRE(t.get_subscription("aaaaaaaaaaaa"_n)["balance"].as<asset>() < asset::from_string("100000.0000 TST"));
+      BOOST_REQUIRE_EQUAL(t.get_state().net.utilization, net_weight / 100);
+   }
+
 } // rent_tests
 FC_LOG_AND_RETHROW()
 
+BOOST_AUTO_TEST_CASE(fee_kernel_tests) try {
+   auto init = [](auto& t, double net_exponent, double cpu_exponent) {
+      t.produce_block();
+      BOOST_REQUIRE_EQUAL("", t.configbw(t.make_config([&](auto& config) {
+         config.net.current_weight_ratio = powerup_frac / 4;
+         config.net.target_weight_ratio  = powerup_frac / 4;
+         config.net.exponent             = net_exponent;
+         config.net.min_price            = asset::from_string("123456.7890 TST");
+         config.net.max_price            = asset::from_string("2000000.0000 TST");
+
+         config.cpu.current_weight_ratio = powerup_frac / 5;
+         config.cpu.target_weight_ratio  = powerup_frac / 5;
+         config.cpu.assumed_stake_weight = stake_weight / 2;
+         config.cpu.exponent             = cpu_exponent;
+         config.cpu.max_price            = asset::from_string("6000000.0000 TST");
+      })));
+      t.start_rex();
+      t.create_account_with_resources("aaaaaaaaaaaa"_n, config::system_account_name, core_sym::from_string("1.0000"),
+                                      false, core_sym::from_string("500.0000"), core_sym::from_string("500.0000"));
+      t.create_account_with_resources("bbbbbbbbbbbb"_n, config::system_account_name, core_sym::from_string("1.0000"),
+                                      false, core_sym::from_string("500.0000"), core_sym::from_string("500.0000"));
+      t.transfer(config::system_account_name, "aaaaaaaaaaaa"_n, core_sym::from_string("9000000.0000"));
+   };
+
+   // exponents 1, 2 and 3 are evaluated with multiplications; the fee must not differ from std::pow
+   for (auto [net_exponent, cpu_exponent] : std::vector<std::pair<double, double>>{ { 1, 2 }, { 2, 3 }, { 3, 1 } }) {
+      powerup_tester t;
+      init(t, net_exponent, cpu_exponent);
+      for (double frac : { .0137, .0911, .2213, .3119 }) {
+         auto    state      = t.get_state();
+         int64_t powup_frac = powerup_frac * frac;
+         int64_t net_amount = static_cast<eosio::chain::int128_t>(powup_frac) * state.net.weight / powerup_frac;
+         int64_t cpu_amount = static_cast<eosio::chain::int128_t>(powup_frac) * state.cpu.weight / powerup_frac;
+         asset   fee{ generic_powerup_fee(state.net, net_amount) + generic_powerup_fee(state.cpu, cpu_amount),
+                      symbol{ CORE_SYM } };
+         t.check_powerup("aaaaaaaaaaaa"_n, "bbbbbbbbbbbb"_n, 30, powup_frac, powup_frac, fee, net_amount, cpu_amount);
+      }
+   }
+
+   // billed CPU of powerup with the default exponent compared to a non-integer exponent
+   auto billed_cpu = [&](double exponent) {
+      powerup_tester t;
+      init(t, exponent, exponent);
+      uint32_t min_cpu = std::numeric_limits<uint32_t>::max();
+      for (int64_t i = 0; i < 10; ++i) {
+         auto trace = t.base_tester::push_action(config::system_account_name, "powerup"_n, "aaaaaaaaaaaa"_n,
+                                                 mvo()("payer", "aaaaaaaaaaaa"_n)("receiver", "bbbbbbbbbbbb"_n)("days", 30)(
+                                                       "net_frac", powerup_frac / 100 + i)("cpu_frac", powerup_frac / 100 + i)(
+                                                       "max_payment", asset::from_string("9000000.0000 TST")));
+         min_cpu = std::min(min_cpu, trace->receipt->cpu_usage_us);
+      }
+      return min_cpu;
+   };
+   const uint32_t integer_cpu = billed_cpu(2.0);
+   const uint32_t generic_cpu = billed_cpu(2.5);
+   BOOST_TEST_MESSAGE("powerup billed CPU: exponent 2.0 " << integer_cpu << " us, exponent 2.5 " << generic_cpu << " us");
+   BOOST_CHECK_LE(integer_cpu, generic_cpu + generic_cpu / 10);
+}
+FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -267,6 +267,30 @@ public:
       return buyrambytes( account_name(payer), account_name(receiver), numbytes );
    }
 
+   action_result buyrambatch( const account_name& payer, const vector<std::pair<account_name, uint32_t>>& purchases ) {
+      vector<mvo> ps;
+      for( const auto& [receiver, numbytes] : purchases )
+         ps.push_back( mvo()("receiver", receiver)("bytes", numbytes) );
+      return push_action( payer, "buyrambatch"_n, mvo()( "payer",payer)("purchases",ps) );
+   }
+
+   action_result ramtransfer( const account_name& from, const account_name& to, int64_t numbytes, const std::string& memo = "" ) {
+      return push_action( from, "ramtransfer"_n, mvo()( "from",from)("to",to)("bytes",numbytes)("memo",memo) );
+   }
+
+   action_result onboard( const account_name& creator, const account_name& newact, uint32_t ram_bytes,
+                          const asset& net, const asset& cpu, bool transfer = false ) {
+      return push_action( creator, "onboard"_n, mvo()
+                          ("creator", creator)
+                          ("newact", newact)
+                          ("owner", authority( get_public_key( newact, "owner" ) ))
+                          ("active", authority( get_public_key( newact, "active" ) ))
+                          ("ram_bytes", ram_bytes)
+                          ("stake_net_quantity", net)
+                          ("stake_cpu_quantity", cpu)
+                          ("transfer", transfer) );
+   }
+
    action_result sellram( const account_name& account, uint64_t numbytes ) {
       return push_action( account, "sellram"_n, mvo()( "account", account)("bytes",numbytes) );
    }
@@ -305,6 +329,17 @@ public:
       return stake( account_name(acnt), net, cpu );
    }
 
+   action_result delegatebws( const account_name& from, const vector<std::tuple<account_name, asset, asset>>& delegations ) {
+      vector<fc::variant> items;
+      for ( const auto& [receiver, net, cpu] : delegations ) {
+         items.emplace_back( mvo()("receiver", receiver)("stake_net_quantity", net)("stake_cpu_quantity", cpu) );
+      }
+      return push_action( name(from), "delegatebws"_n, mvo()
+                          ("from",        from)
+                          ("delegations", items)
+      );
+   }
+
    action_result stake_with_transfer( const account_name& from, const account_name& to, const asset& net, const asset& cpu ) {
       return push_action( name(from), "delegatebw"_n, mvo()
                           ("from",     from)
@@ -325,6 +360,14 @@ public:
       return stake_with_transfer( account_name(acnt), net, cpu );
    }
 
+   action_result refund( const account_name& owner ) {
+      return push_action( owner, "refund"_n, mvo()("owner", owner) );
+   }
+
+   action_result refundexec( const account_name& user, const std::vector<account_name>& owners ) {
+      return push_action( user, "refundexec"_n, mvo()("user", user)("owners", owners) );
+   }
+
    action_result unstake( const account_name& from, const account_name& to, const asset& net, const asset& cpu ) {
       return push_action( name(from), "undelegatebw"_n, mvo()
                           ("from",     from)
@@ -456,6 +499,19 @@ public:
       return output;
    }
 
+   auto get_rexorders_result( const transaction_trace_ptr& trace ) {
+      std::vector<std::pair<account_name, asset>> output;
+      for ( size_t i = 0; i < trace->action_traces.size(); ++i ) {
+         if ( trace->action_traces[i].act.name == "orderresults"_n ) {
+            fc::datastream<const char*> ds( trace->action_traces[i].act.data.data(),
+                                            trace->action_traces[i].act.data.size() );
+            std::vector<std::pair<account_name, asset>> fills; fc::raw::unpack( ds, fills );
+            output.insert( output.end(), fills.begin(), fills.end() );
+         }
+      }
+      return output;
+   }
+
    action_result cancelrexorder( const account_name& owner ) {
       return push_action( name(owner), "cnclrexorder"_n, mvo()("owner", owner) );
    }
@@ -544,10 +600,23 @@ public:
       return push_action( name(owner), "updaterex"_n, mvo()("owner", owner) );
    }
 
+   action_result syncrexvotes( const account_name& user, uint16_t max ) {
+      return push_action( name(user), "syncrexvotes"_n, mvo()("user", user)("max", max) );
+   }
+
    action_result rexexec( const account_name& user, uint16_t max ) {
       return push_action( name(user), "rexexec"_n, mvo()("user", user)("max", max) );
    }
 
+   action_result rexexec2( const account_name& user, uint32_t budget ) {
+      return push_action( name(user), "rexexec2"_n, mvo()("user", user)("budget", budget) );
+   }
+
+   fc::variant get_rex_exec_cursor() const {
+      vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "rexcursor"_n, "rexcursor"_n );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "rex_exec_cursor", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
    action_result consolidate( const account_name& owner ) {
       return push_action( name(owner), "consolidate"_n, mvo()("owner", owner) );
    }
@@ -564,6 +633,10 @@ public:
       return push_action( name(owner), "closerex"_n, mvo()("owner", owner) );
    }
 
+   action_result migraterex( const account_name& owner ) {
+      return push_action( name(owner), "migraterex"_n, mvo()("owner", owner) );
+   }
+
    fc::variant get_last_loan(bool cpu) {
       vector<char> data;
       const auto& db = control->db();
@@ -617,29 +690,80 @@ public:
       return data.empty() ? fc::variant() : abi_ser.binary_to_variant("delegated_bandwidth", data, abi_serializer::create_yield_function(abi_serializer_max_time));
    }
 
-   asset get_rex_balance( const account_name& act ) const {
-      vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "rexbal"_n, act );
-      return data.empty() ? asset(0, symbol(SY(4, REX))) : abi_ser.binary_to_variant("rex_balance", data, abi_serializer::create_yield_function(abi_serializer_max_time))["rex_balance"].as<asset>();
+   fc::variant get_delegator( const account_name& receiver, const account_name& from ) const {
+      vector<char> data = get_row_by_account( config::system_account_name, receiver, "delegators"_n, from );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant("bw_delegator", data, abi_serializer::create_yield_function(abi_serializer_max_time));
    }
 
+   // REX balance of `act` in the shape of a legacy `rexbal` row, built from its `rexaccount` row once migrated
    fc::variant get_rex_balance_obj( const account_name& act ) const {
+      auto racct = get_rex_account_obj( act );
+      if ( racct.is_null() ) {
+         return get_legacy_rex_balance_obj( act );
+      }
+      if ( racct["rex_balance"].as<asset>().get_symbol().value() == 0 ) {
+         return fc::variant();
+      }
+      const uint32_t matured_day = racct["matured_day"].as<uint32_t>();
+      const auto     maturing    = racct["maturing_rex"].as<std::vector<int64_t>>();
+      vector<fc::variant> maturities;
+      for ( uint32_t day = matured_day + 1; day <= matured_day + maturing.size(); ++day ) {
+         if ( maturing[day % maturing.size()] > 0 ) {
+            maturities.emplace_back( mvo()("first", time_point_sec( day * 24 * 3600 ))("second", maturing[day % maturing.size()]) );
+         }
+      }
+      if ( racct["savings_rex"].as<int64_t>() > 0 ) {
+         maturities.emplace_back( mvo()("first", time_point_sec::maximum())("second", racct["savings_rex"].as<int64_t>()) );
+      }
+      return mvo()
+         ("version", 0)
+         ("owner", act)
+         ("vote_stake", racct["vote_stake"])
+         ("rex_balance", racct["rex_balance"])
+         ("matured_rex", racct["matured_rex"])
+         ("rex_maturities", maturities);
+   }
+
+   fc::variant get_legacy_rex_balance_obj( const account_name& act ) const {
       vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "rexbal"_n, act );
       return data.empty() ? fc::variant() : abi_ser.binary_to_variant("rex_balance", data, abi_serializer::create_yield_function(abi_serializer_max_time));
    }
 
-   asset get_rex_fund( const account_name& act ) const {
-      vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "rexfund"_n, act );
-      return data.empty() ? asset(0, symbol{CORE_SYM}) : abi_ser.binary_to_variant("rex_fund", data, abi_serializer::create_yield_function(abi_serializer_max_time))["balance"].as<asset>();
+   asset get_rex_balance( const account_name& act ) const {
+      auto rb = get_rex_balance_obj( act );
+      return rb.is_null() ? asset(0, symbol(SY(4, REX))) : rb["rex_balance"].as<asset>();
    }
 
+   // REX fund of `act` in the shape of a legacy `rexfund` row, built from its `rexaccount` row once migrated
    fc::variant get_rex_fund_obj( const account_name& act ) const {
+      auto racct = get_rex_account_obj( act );
+      if ( racct.is_null() ) {
+         return get_legacy_rex_fund_obj( act );
+      }
+      if ( racct["fund"].as<asset>().get_symbol().value() == 0 ) {
+         return fc::variant();
+      }
+      return mvo()("version", 0)("owner", act)("balance", racct["fund"]);
+   }
+
+   fc::variant get_legacy_rex_fund_obj( const account_name& act ) const {
       vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "rexfund"_n, act );
       return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "rex_fund", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
    }
 
+   asset get_rex_fund( const account_name& act ) const {
+      auto fund = get_rex_fund_obj( act );
+      return fund.is_null() ? asset(0, symbol{CORE_SYM}) : fund["balance"].as<asset>();
+   }
+
+   fc::variant get_rex_account_obj( const account_name& act ) const {
+      vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "rexaccount"_n, act );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "rex_account_info", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
    asset get_rex_vote_stake( const account_name& act ) const {
-      vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "rexbal"_n, act );
-      return data.empty() ? core_sym::from_string("0.0000") : abi_ser.binary_to_variant("rex_balance", data, abi_serializer::create_yield_function(abi_serializer_max_time))["vote_stake"].as<asset>();
+      auto rb = get_rex_balance_obj( act );
+      return rb.is_null() ? core_sym::from_string("0.0000") : rb["vote_stake"].as<asset>();
    }
 
    fc::variant get_rex_order( const account_name& act ) {
@@ -750,6 +874,20 @@ public:
       return bidname( account_name(bidder), account_name(newname), bid );
    }
 
+   fc::variant get_name_bid_leaderboard() {
+      vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "namebidtop"_n, "namebidtop"_n );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "name_bid_leaderboard", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
+   fc::variant get_closed_bid( const account_name& newname ) {
+      vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name, "closedbids"_n, newname );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "name_bid", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
+   action_result bidrefunds( const account_name& bidder ) {
+      return push_action( name(bidder), "bidrefunds"_n, mvo()("bidder", bidder) );
+   }
+
    static fc::variant_object producer_parameters_example( int n ) {
       return mutable_variant_object()
          ("max_block_net_usage", 10000000 + n )
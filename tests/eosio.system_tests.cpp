@@ -5,6 +5,7 @@
 #include <eosio/chain/wast_to_wasm.hpp>
 #include <cstdlib>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 #include <fc/log/logger.hpp>
 #include <eosio/chain/exceptions.hpp>
@@ -172,6 +173,151 @@ BOOST_FIXTURE_TEST_CASE( buysell, eosio_system_tester ) try {
       BOOST_REQUIRE( within_one( 1024 * 1024, bytes2 - bytes1 ) );
    }
 
+   {
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("purchases can't be empty"), buyrambatch( "bob111111111"_n, {} ) );
+
+      const asset    bob0   = get_balance( "bob111111111" );
+      const asset    ram0   = get_balance( "eosio.ram"_n );
+      const uint64_t bob_bytes0   = get_total_stake( "bob111111111" )["ram_bytes"].as_uint64();
+      const uint64_t carol_bytes0 = get_total_stake( "carol1111111" )["ram_bytes"].as_uint64();
+      const asset    e0     = get_ram_market()["quote"].as<connector>().balance;
+
+      BOOST_REQUIRE_EQUAL( success(), buyrambatch( "bob111111111"_n, { { "bob111111111"_n, 2048 },
+                                                                       { "carol1111111"_n, 4096 } } ) );
+      BOOST_REQUIRE( within_one( 2048, get_total_stake( "bob111111111" )["ram_bytes"].as_uint64() - bob_bytes0 ) );
+      BOOST_REQUIRE( within_one( 4096, get_total_stake( "carol1111111" )["ram_bytes"].as_uint64() - carol_bytes0 ) );
+
+      // one transfer to eosio.ram carries what the market received
+      const asset paid = bob0 - get_balance( "bob111111111" );
+      BOOST_REQUIRE_EQUAL( get_balance( "eosio.ram"_n ) - ram0, get_ram_market()["quote"].as<connector>().balance - e0 );
+      BOOST_REQUIRE( get_balance( "eosio.ram"_n ) - ram0 < paid );
+   }
+
+   {
+      const asset    bob0         = get_balance( "bob111111111" );
+      const asset    e0           = get_ram_market()["quote"].as<connector>().balance;
+      const uint64_t bob_bytes0   = get_total_stake( "bob111111111" )["ram_bytes"].as_uint64();
+      const uint64_t carol_bytes0 = get_total_stake( "carol1111111" )["ram_bytes"].as_uint64();
+
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("must transfer positive bytes"), ramtransfer( "bob111111111"_n, "carol1111111"_n, 0 ) );
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("must transfer positive bytes"), ramtransfer( "bob111111111"_n, "carol1111111"_n, -1 ) );
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("cannot transfer to self"), ramtransfer( "bob111111111"_n, "bob111111111"_n, 100 ) );
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("insufficient quota"),
+                           ramtransfer( "bob111111111"_n, "carol1111111"_n, bob_bytes0 + 1 ) );
+
+      int64_t carol_ram0 = 0, carol_ram1 = 0, net = 0, cpu = 0;
+      control->get_resource_limits_manager().get_account_limits( "carol1111111"_n, carol_ram0, net, cpu );
+      BOOST_REQUIRE_EQUAL( success(), ramtransfer( "bob111111111"_n, "carol1111111"_n, 1000, "rebalance" ) );
+      BOOST_REQUIRE_EQUAL( bob_bytes0 - 1000, get_total_stake( "bob111111111" )["ram_bytes"].as_uint64() );
+      BOOST_REQUIRE_EQUAL( carol_bytes0 + 1000, get_total_stake( "carol1111111" )["ram_bytes"].as_uint64() );
+      control->get_resource_limits_manager().get_account_limits( "carol1111111"_n, carol_ram1, net, cpu );
+      BOOST_REQUIRE_EQUAL( carol_ram0 + 1000, carol_ram1 );
+
+      // no tokens move and the market is unchanged
+      BOOST_REQUIRE_EQUAL( bob0, get_balance( "bob111111111" ) );
+      BOOST_REQUIRE_EQUAL( e0, get_ram_market()["quote"].as<connector>().balance );
+
+      // accounts with managed ram can neither send nor receive quota
+      BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, "setacctram"_n, mvo()
+                                                   ("account", "carol1111111")("ram_bytes", carol_ram1) ) );
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("cannot transfer to an account with managed ram"),
+                           ramtransfer( "bob111111111"_n, "carol1111111"_n, 100 ) );
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("cannot transfer from an account with managed ram"),
+                           ramtransfer( "carol1111111"_n, "bob111111111"_n, 100 ) );
+      BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, "setacctram"_n, mvo()
+                                                   ("account", "carol1111111")("ram_bytes", fc::variant()) ) );
+      BOOST_REQUIRE_EQUAL( success(), ramtransfer( "carol1111111"_n, "bob111111111"_n, 100 ) );
+   }
+
+   {
+      auto get_ram_twap = [this]() -> fc::variant {
+         vector<char> data = get_row_by_account( config::system_account_name, config::system_account_name,
+                                                 "ramtwap"_n, "ramtwap"_n );
+         BOOST_REQUIRE( !data.empty() );
+         return abi_ser.binary_to_variant("ram_price_accumulator", data, abi_serializer::create_yield_function(abi_serializer_max_time));
+      };
+
+      produce_block( fc::seconds(10) );
+      BOOST_REQUIRE_EQUAL( success(), buyrambytes( "bob111111111", "bob111111111", 1024 ) );
+      auto twap0   = get_ram_twap();
+      auto market  = get_ram_market();
+      const eosio::chain::uint128_t price = ( eosio::chain::uint128_t(market["quote"].as<connector>().balance.get_amount()) << 32 )
+                                            / market["base"].as<connector>().balance.get_amount();
+
+      // the price left by the last purchase accumulates until the market changes again
+      produce_block( fc::seconds(10) );
+      BOOST_REQUIRE_EQUAL( success(), buyrambytes( "bob111111111", "bob111111111", 1024 ) );
+      auto twap1 = get_ram_twap();
+      const uint32_t elapsed = twap1["last_update"].as<fc::time_point_sec>().sec_since_epoch()
+                               - twap0["last_update"].as<fc::time_point_sec>().sec_since_epoch();
+      BOOST_REQUIRE( elapsed >= 10 );
+      BOOST_REQUIRE( twap1["price_cumulative"].as<eosio::chain::uint128_t>()
+                     - twap0["price_cumulative"].as<eosio::chain::uint128_t>() == price * elapsed );
+   }
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( onboard_account, eosio_system_tester ) try {
+   transfer( config::system_account_name, "alice1111111"_n, core_sym::from_string("1000.0000"), config::system_account_name );
+   const asset alice0  = get_balance( "alice1111111" );
+   const int64_t voted0 = get_voter_info( "alice1111111" )["staked"].as_int64();
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("account already exists"),
+                        onboard( "alice1111111"_n, "bob111111111"_n, 8000, core_sym::from_string("10.0000"), core_sym::from_string("5.0000") ) );
+
+   BOOST_REQUIRE_EQUAL( success(), onboard( "alice1111111"_n, "onboarded111"_n, 8000,
+                                            core_sym::from_string("10.0000"), core_sym::from_string("5.0000") ) );
+   auto total = get_total_stake( "onboarded111" );
+   BOOST_REQUIRE( within_one( 8000, total["ram_bytes"].as_uint64() ) );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("10.0000"), total["net_weight"].as<asset>() );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("5.0000"), total["cpu_weight"].as<asset>() );
+
+   int64_t ram_bytes = 0, net = 0, cpu = 0;
+   control->get_resource_limits_manager().get_account_limits( "onboarded111"_n, ram_bytes, net, cpu );
+   BOOST_REQUIRE_EQUAL( total["ram_bytes"].as_int64() + 1400, ram_bytes );
+   BOOST_REQUIRE_EQUAL( 100000, net );
+   BOOST_REQUIRE_EQUAL( 50000, cpu );
+
+   // the stake is delegated by the creator, as with delegatebw
+   auto dbw = get_dbw_obj( "alice1111111"_n, "onboarded111"_n );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("10.0000"), dbw["net_weight"].as<asset>() );
+   BOOST_REQUIRE_EQUAL( voted0 + 150000, get_voter_info( "alice1111111" )["staked"].as_int64() );
+   BOOST_REQUIRE( alice0 - core_sym::from_string("15.0000") > get_balance( "alice1111111" ) );
+
+   // with transfer, the new account owns its stake
+   BOOST_REQUIRE_EQUAL( success(), onboard( "alice1111111"_n, "onboarded112"_n, 8000,
+                                            core_sym::from_string("1.0000"), core_sym::from_string("2.0000"), true ) );
+   BOOST_REQUIRE( get_dbw_obj( "alice1111111"_n, "onboarded112"_n ).is_null() );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("2.0000"), get_dbw_obj( "onboarded112"_n, "onboarded112"_n )["cpu_weight"].as<asset>() );
+   BOOST_REQUIRE_EQUAL( 30000, get_voter_info( "onboarded112" )["staked"].as_int64() );
+   // the pending onboarding is kept in the onboarding table only
+   BOOST_REQUIRE( get_row_by_account( config::system_account_name, config::system_account_name, "newacctcfg"_n, "newacctcfg"_n ).empty() );
+   BOOST_REQUIRE( get_row_by_account( config::system_account_name, config::system_account_name, "onboarding"_n, "onboarded112"_n ).empty() );
+   BOOST_REQUIRE_EQUAL( success(), unstake( "onboarded112", "onboarded112", core_sym::from_string("1.0000"), core_sym::from_string("2.0000") ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( defer_new_account_resources, eosio_system_tester ) try {
+   BOOST_REQUIRE_EQUAL( error("missing authority of eosio"),
+                        push_action( "alice1111111"_n, "cfgnewacct"_n, mvo()("defer_userres", true) ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, "cfgnewacct"_n, mvo()("defer_userres", true) ) );
+
+   // the row is created by the purchases made in the same transaction as newaccount
+   create_account_with_resources( "deferred1111"_n, config::system_account_name, core_sym::from_string("1.0000"), false );
+   auto total = get_total_stake( "deferred1111" );
+   BOOST_REQUIRE( !total.is_null() );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("10.0000"), total["net_weight"].as<asset>() );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("10.0000"), total["cpu_weight"].as<asset>() );
+   BOOST_REQUIRE( 0 < total["ram_bytes"].as_int64() );
+
+   int64_t ram_bytes = 0, net = 0, cpu = 0;
+   control->get_resource_limits_manager().get_account_limits( "deferred1111"_n, ram_bytes, net, cpu );
+   BOOST_REQUIRE( total["ram_bytes"].as_int64() < ram_bytes );
+   BOOST_REQUIRE_EQUAL( 100000, net );
+   BOOST_REQUIRE_EQUAL( 100000, cpu );
+
+   BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, "cfgnewacct"_n, mvo()("defer_userres", false) ) );
+   create_account_with_resources( "deferred2222"_n, config::system_account_name, core_sym::from_string("1.0000"), false );
+   BOOST_REQUIRE_EQUAL( total["net_weight"].as<asset>(), get_total_stake( "deferred2222" )["net_weight"].as<asset>() );
 } FC_LOG_AND_RETHROW()
 
 BOOST_FIXTURE_TEST_CASE( stake_unstake, eosio_system_tester ) try {
@@ -199,11 +345,14 @@ BOOST_FIXTURE_TEST_CASE( stake_unstake, eosio_system_tester ) try {
 
    produce_block( fc::hours(3*24-1) );
    produce_blocks(1);
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("refund is not available yet"), refund( "alice1111111"_n ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("700.0000"), get_balance( "alice1111111" ) );
    BOOST_REQUIRE_EQUAL( init_eosio_stake_balance + core_sym::from_string("300.0000"), get_balance( "eosio.stake"_n ) );
-   //after 3 days funds should be released
+   //after 3 days funds can be claimed
    produce_block( fc::hours(1) );
    produce_blocks(1);
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("700.0000"), get_balance( "alice1111111" ) );
+   BOOST_REQUIRE_EQUAL( success(), refund( "alice1111111"_n ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("1000.0000"), get_balance( "alice1111111" ) );
    BOOST_REQUIRE_EQUAL( init_eosio_stake_balance, get_balance( "eosio.stake"_n ) );
 
@@ -229,14 +378,18 @@ BOOST_FIXTURE_TEST_CASE( stake_unstake, eosio_system_tester ) try {
    BOOST_REQUIRE_EQUAL( core_sym::from_string("10.0000"), total["cpu_weight"].as<asset>());
    produce_block( fc::hours(3*24-1) );
    produce_blocks(1);
+   BOOST_REQUIRE_EQUAL( success(), refundexec( "bob111111111"_n, { "alice1111111"_n } ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("700.0000"), get_balance( "alice1111111" ) );
-   //after 3 days funds should be released
+   //after 3 days funds can be claimed by anyone on behalf of alice
    produce_block( fc::hours(1) );
    produce_blocks(1);
 
    REQUIRE_MATCHING_OBJECT( voter( "alice1111111", core_sym::from_string("0.0000") ), get_voter_info( "alice1111111" ) );
-   produce_blocks(1);
+   // owners without a matured refund are skipped
+   BOOST_REQUIRE_EQUAL( success(), refundexec( "bob111111111"_n, { "carol1111111"_n, "alice1111111"_n, "alice1111111"_n } ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("1000.0000"), get_balance( "alice1111111" ) );
+   BOOST_REQUIRE( get_refund_request( "alice1111111"_n ).is_null() );
+   BOOST_REQUIRE( get_row_by_account( config::system_account_name, config::system_account_name, "refundqueue"_n, "alice1111111"_n ).empty() );
 } FC_LOG_AND_RETHROW()
 
 BOOST_FIXTURE_TEST_CASE( stake_unstake_with_transfer, eosio_system_tester ) try {
@@ -274,11 +427,12 @@ BOOST_FIXTURE_TEST_CASE( stake_unstake_with_transfer, eosio_system_tester ) try
    produce_block( fc::hours(3*24-1) );
    produce_blocks(1);
    BOOST_REQUIRE_EQUAL( core_sym::from_string("700.0000"), get_balance( "alice1111111" ) );
-   //after 3 days funds should be released
+   //after 3 days funds can be claimed
 
    produce_block( fc::hours(1) );
    produce_blocks(1);
 
+   BOOST_REQUIRE_EQUAL( success(), refund( "alice1111111"_n ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("1300.0000"), get_balance( "alice1111111" ) );
 
    //stake should be equal to what was staked in constructor, voting power should be 0
@@ -304,6 +458,46 @@ BOOST_FIXTURE_TEST_CASE( stake_to_self_with_transfer, eosio_system_tester ) try
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE( stake_to_many_receivers, eosio_system_tester ) try {
+   cross_15_percent_threshold();
+
+   transfer( "eosio", "alice1111111", core_sym::from_string("1000.0000"), "eosio" );
+   const asset init_eosio_stake_balance = get_balance( "eosio.stake"_n );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("delegations can't be empty"), delegatebws( "alice1111111"_n, {} ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("cannot delegate to self with delegatebws"),
+                        delegatebws( "alice1111111"_n, { { "alice1111111"_n, core_sym::from_string("1.0000"), core_sym::from_string("1.0000") } } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("must stake a positive amount"),
+                        delegatebws( "alice1111111"_n, { { "bob111111111"_n, core_sym::from_string("0.0000"), core_sym::from_string("0.0000") } } ) );
+
+   BOOST_REQUIRE_EQUAL( success(), delegatebws( "alice1111111"_n, {
+      { "bob111111111"_n,  core_sym::from_string("100.0000"), core_sym::from_string("50.0000") },
+      { "carol1111111"_n,  core_sym::from_string("20.0000"),  core_sym::from_string("30.0000") },
+      { "bob111111111"_n,  core_sym::from_string("5.0000"),   core_sym::from_string("5.0000") }
+   } ) );
+
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("790.0000"), get_balance( "alice1111111" ) );
+   BOOST_REQUIRE_EQUAL( init_eosio_stake_balance + core_sym::from_string("210.0000"), get_balance( "eosio.stake"_n ) );
+
+   auto dbw = get_dbw_obj( "alice1111111"_n, "bob111111111"_n );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("105.0000"), dbw["net_weight"].as<asset>() );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("55.0000"),  dbw["cpu_weight"].as<asset>() );
+   auto total = get_total_stake( "carol1111111" );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("30.0000"), total["net_weight"].as<asset>() );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("40.0000"), total["cpu_weight"].as<asset>() );
+   REQUIRE_MATCHING_OBJECT( voter( "alice1111111", core_sym::from_string("210.0000") ), get_voter_info( "alice1111111" ) );
+   BOOST_REQUIRE_EQUAL( "alice1111111", get_delegator( "bob111111111"_n, "alice1111111"_n )["from"].as_string() );
+   BOOST_REQUIRE_EQUAL( "alice1111111", get_delegator( "carol1111111"_n, "alice1111111"_n )["from"].as_string() );
+
+   // delegations are undone one receiver at a time
+   BOOST_REQUIRE_EQUAL( success(), unstake( "alice1111111", "carol1111111", core_sym::from_string("20.0000"), core_sym::from_string("30.0000") ) );
+   BOOST_REQUIRE( get_dbw_obj( "alice1111111"_n, "carol1111111"_n ).is_null() );
+   BOOST_REQUIRE( get_delegator( "carol1111111"_n, "alice1111111"_n ).is_null() );
+   BOOST_REQUIRE( !get_delegator( "bob111111111"_n, "alice1111111"_n ).is_null() );
+   REQUIRE_MATCHING_OBJECT( voter( "alice1111111", core_sym::from_string("160.0000") ), get_voter_info( "alice1111111" ) );
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_FIXTURE_TEST_CASE( stake_while_pending_refund, eosio_system_tester ) try {
    cross_15_percent_threshold();
 
@@ -338,11 +532,12 @@ BOOST_FIXTURE_TEST_CASE( stake_while_pending_refund, eosio_system_tester ) try {
    produce_block( fc::hours(3*24-1) );
    produce_blocks(1);
    BOOST_REQUIRE_EQUAL( core_sym::from_string("700.0000"), get_balance( "alice1111111" ) );
-   //after 3 days funds should be released
+   //after 3 days funds can be claimed
 
    produce_block( fc::hours(1) );
    produce_blocks(1);
 
+   BOOST_REQUIRE_EQUAL( success(), refund( "alice1111111"_n ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("1300.0000"), get_balance( "alice1111111" ) );
 
    //stake should be equal to what was staked in constructor, voting power should be 0
@@ -1072,9 +1267,10 @@ BOOST_FIXTURE_TEST_CASE( vote_for_producer, eosio_system_tester, * boost::unit_t
    prod = get_producer_info( "alice1111111" );
    BOOST_TEST_REQUIRE( 0.0 == prod["total_votes"].as_double() );
 
-   //carol1111111 should receive funds in 3 days
+   //carol1111111 can claim funds in 3 days
    produce_block( fc::days(3) );
    produce_block();
+   BOOST_REQUIRE_EQUAL( success(), refund( "carol1111111"_n ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("3000.0000"), get_balance( "carol1111111" ) );
 
 } FC_LOG_AND_RETHROW()
@@ -3320,9 +3516,13 @@ BOOST_FIXTURE_TEST_CASE( multiple_namebids, eosio_system_tester ) try {
       const asset initial_names_balance = get_balance("eosio.names"_n);
       BOOST_REQUIRE_EQUAL( success(),
                            bidname( "alice", "prefb", core_sym::from_string("1.1001") ) );
-      BOOST_REQUIRE_EQUAL( core_sym::from_string( "9997.9997" ), get_balance("bob") );
+      BOOST_REQUIRE_EQUAL( core_sym::from_string( "9996.9997" ), get_balance("bob") );
       BOOST_REQUIRE_EQUAL( core_sym::from_string( "9998.8999" ), get_balance("alice") );
+      BOOST_REQUIRE_EQUAL( initial_names_balance + core_sym::from_string("1.1001"), get_balance("eosio.names"_n) );
+      BOOST_REQUIRE_EQUAL( success(), bidrefunds( "bob" ) );
+      BOOST_REQUIRE_EQUAL( core_sym::from_string( "9997.9997" ), get_balance("bob") );
       BOOST_REQUIRE_EQUAL( initial_names_balance + core_sym::from_string("0.1001"), get_balance("eosio.names"_n) );
+      BOOST_REQUIRE_EQUAL( wasm_assert_msg("refund not found"), bidrefunds( "bob" ) );
    }
 
    // david outbids carl on prefd
@@ -3331,14 +3531,27 @@ BOOST_FIXTURE_TEST_CASE( multiple_namebids, eosio_system_tester ) try {
       BOOST_REQUIRE_EQUAL( core_sym::from_string( "10000.0000" ), get_balance("david") );
       BOOST_REQUIRE_EQUAL( success(),
                            bidname( "david", "prefd", core_sym::from_string("1.9900") ) );
-      BOOST_REQUIRE_EQUAL( core_sym::from_string( "9999.0000" ), get_balance("carl") );
+      BOOST_REQUIRE_EQUAL( core_sym::from_string( "9998.0000" ), get_balance("carl") );
       BOOST_REQUIRE_EQUAL( core_sym::from_string( "9998.0100" ), get_balance("david") );
    }
 
-   // eve outbids carl on prefe
+   // eve outbids carl on prefe, carl claims both refunds in one transfer
    {
       BOOST_REQUIRE_EQUAL( success(),
                            bidname( "eve", "prefe", core_sym::from_string("1.7200") ) );
+      BOOST_REQUIRE_EQUAL( success(), bidrefunds( "carl" ) );
+      BOOST_REQUIRE_EQUAL( core_sym::from_string( "10000.0000" ), get_balance("carl") );
+   }
+
+   // open auctions are listed by highest bid
+   {
+      const auto top = get_name_bid_leaderboard()["top"].get_array();
+      const std::vector<std::string> expected = { "prefd", "prefe", "prefb", "prefa", "prefc" };
+      BOOST_REQUIRE_EQUAL( expected.size(), top.size() );
+      for ( size_t i = 0; i < expected.size(); ++i ) {
+         BOOST_REQUIRE_EQUAL( expected[i], top[i]["newname"].as_string() );
+      }
+      BOOST_REQUIRE_EQUAL( 19900, top[0]["high_bid"].as_int64() );
    }
 
    // produce_block( fc::days(14) );
@@ -3356,7 +3569,12 @@ BOOST_FIXTURE_TEST_CASE( multiple_namebids, eosio_system_tester ) try {
                             fc::exception, fc_assert_exception_message_is( not_closed_message ) );
    // it's been 14 days, auction for prefd has been closed
    produce_block( fc::days(12) );
+   BOOST_REQUIRE_EQUAL( -19900, get_closed_bid( "prefd"_n )["high_bid"].as_int64() );
+   BOOST_REQUIRE_EQUAL( "prefe", get_name_bid_leaderboard()["top"].get_array()[0]["newname"].as_string() );
+   BOOST_REQUIRE_EQUAL( error("assertion failure with message: this auction has already closed"),
+                        bidname( "alice", "prefd", core_sym::from_string("3.0000") ) );
    create_account_with_resources( "prefd"_n, "david"_n );
+   BOOST_REQUIRE( get_closed_bid( "prefd"_n ).is_null() );
    produce_blocks(2);
    produce_block( fc::hours(23) );
    // auctions for prefa, prefb, prefc, prefe haven't been closed
@@ -4400,6 +4618,117 @@ BOOST_FIXTURE_TEST_CASE( buy_sell_claim_rex, eosio_system_tester ) try {
 } FC_LOG_AND_RETHROW()
 
 
+BOOST_FIXTURE_TEST_CASE( match_rex_orders, eosio_system_tester ) try {
+
+   const asset init_balance = core_sym::from_string("3000000.0000");
+   const std::vector<account_name> accounts = { "aliceaccount"_n, "bobbyaccount"_n, "carolaccount"_n, "emilyaccount"_n, "frankaccount"_n };
+   account_name alice = accounts[0], bob = accounts[1], carol = accounts[2], emily = accounts[3], frank = accounts[4];
+   setup_rex_accounts( accounts, init_balance );
+
+   const auto purchase = core_sym::from_string("100000.0000");
+   BOOST_REQUIRE_EQUAL( success(), buyrex( alice, purchase ) );
+   BOOST_REQUIRE_EQUAL( success(), buyrex( bob,   purchase ) );
+   BOOST_REQUIRE_EQUAL( success(), buyrex( carol, purchase ) );
+   for (uint8_t i = 0; i < 4; ++i) {
+      BOOST_REQUIRE_EQUAL( success(), rentcpu( emily, emily, core_sym::from_string("12000.0000") ) );
+   }
+
+   produce_block( fc::days(5) );
+
+   // loans leave too little unlent for any order to be filled
+   BOOST_REQUIRE_EQUAL( success(), sellrex( bob,   get_rex_balance(bob) ) );
+   BOOST_REQUIRE_EQUAL( success(), sellrex( carol, get_rex_balance(carol) ) );
+   BOOST_REQUIRE_EQUAL( success(), sellrex( alice, get_rex_balance(alice) ) );
+   BOOST_REQUIRE_EQUAL( true,      get_rex_order(bob)["is_open"].as<bool>() );
+   BOOST_REQUIRE_EQUAL( true,      get_rex_order(carol)["is_open"].as<bool>() );
+   BOOST_REQUIRE_EQUAL( true,      get_rex_order(alice)["is_open"].as<bool>() );
+
+   // all loans expire together and the whole queue is filled in one pass
+   produce_block( fc::days(26) );
+   {
+      auto trace  = base_tester::push_action( config::system_account_name, "matchrex"_n, frank,
+                                              mvo()("user", frank)("max", 10) );
+      auto output = get_rexorders_result( trace );
+      BOOST_REQUIRE_EQUAL( 0,                get_rexorder_result( trace ).size() );
+      BOOST_REQUIRE_EQUAL( 3,                output.size() );
+      BOOST_REQUIRE_EQUAL( bob,              output[0].first );
+      BOOST_REQUIRE_EQUAL( carol,            output[1].first );
+      BOOST_REQUIRE_EQUAL( alice,            output[2].first );
+      for ( const auto& fill : output ) {
+         BOOST_REQUIRE_EQUAL( false,         get_rex_order(fill.first)["is_open"].as<bool>() );
+         BOOST_REQUIRE_EQUAL( fill.second,   get_rex_order(fill.first)["proceeds"].as<asset>() );
+         BOOST_TEST_REQUIRE ( purchase.get_amount() <= fill.second.get_amount() );
+      }
+   }
+
+   const auto& rex_pool = get_rex_pool();
+   BOOST_REQUIRE_EQUAL( 0, rex_pool["total_rex"].as<asset>().get_amount() );
+   BOOST_REQUIRE_EQUAL( 0, rex_pool["total_lent"].as<asset>().get_amount() );
+   BOOST_REQUIRE_EQUAL( 0, rex_pool["total_lendable"].as<asset>().get_amount() );
+   BOOST_REQUIRE_EQUAL( 0, rex_pool["total_unlent"].as<asset>().get_amount() );
+
+   const asset bob_proceeds = get_rex_order(bob)["proceeds"].as<asset>();
+   BOOST_REQUIRE_EQUAL( success(),                               updaterex( bob ) );
+   BOOST_REQUIRE_EQUAL( init_balance - purchase + bob_proceeds, get_rex_fund( bob ) );
+   BOOST_REQUIRE_EQUAL( true,                                    get_rex_order_obj( bob ).is_null() );
+
+} FC_LOG_AND_RETHROW()
+
+
+BOOST_FIXTURE_TEST_CASE( rexexec2_budget, eosio_system_tester ) try {
+
+   const asset init_balance = core_sym::from_string("3000000.0000");
+   const std::vector<account_name> accounts = { "aliceaccount"_n, "bobbyaccount"_n, "carolaccount"_n, "emilyaccount"_n, "frankaccount"_n };
+   account_name alice = accounts[0], bob = accounts[1], carol = accounts[2], emily = accounts[3], frank = accounts[4];
+   setup_rex_accounts( accounts, init_balance );
+
+   const auto purchase = core_sym::from_string("100000.0000");
+   BOOST_REQUIRE_EQUAL( success(), buyrex( alice, purchase ) );
+   BOOST_REQUIRE_EQUAL( success(), buyrex( bob,   purchase ) );
+   BOOST_REQUIRE_EQUAL( success(), buyrex( carol, purchase ) );
+   for (uint8_t i = 0; i < 4; ++i) {
+      BOOST_REQUIRE_EQUAL( success(), rentcpu( emily, emily, core_sym::from_string("12000.0000") ) );
+   }
+
+   produce_block( fc::days(5) );
+   BOOST_REQUIRE_EQUAL( success(), sellrex( bob,   get_rex_balance(bob) ) );
+   BOOST_REQUIRE_EQUAL( success(), sellrex( carol, get_rex_balance(carol) ) );
+   BOOST_REQUIRE_EQUAL( success(), sellrex( alice, get_rex_balance(alice) ) );
+   produce_block( fc::days(26) );
+
+   // 4 work units per loan: budget covers exactly the 4 expired loans
+   BOOST_REQUIRE_EQUAL( success(), rexexec2( frank, 16 ) );
+   BOOST_REQUIRE_EQUAL( true,      get_cpu_loan( 4 ).is_null() );
+   BOOST_REQUIRE_EQUAL( true,      get_rex_order(bob)["is_open"].as<bool>() );
+   BOOST_REQUIRE_EQUAL( 0,         get_rex_exec_cursor()["stage"].as<uint8_t>() );
+
+   // 2 work units per order: bob's and carol's orders are filled, alice's is next in line
+   {
+      auto trace  = base_tester::push_action( config::system_account_name, "rexexec2"_n, frank,
+                                              mvo()("user", frank)("budget", 4) );
+      auto output = get_rexorders_result( trace );
+      BOOST_REQUIRE_EQUAL( 2,      output.size() );
+      BOOST_REQUIRE_EQUAL( bob,    output[0].first );
+      BOOST_REQUIRE_EQUAL( carol,  output[1].first );
+   }
+   BOOST_REQUIRE_EQUAL( true,      get_rex_order(alice)["is_open"].as<bool>() );
+   BOOST_REQUIRE_EQUAL( 2,         get_rex_exec_cursor()["stage"].as<uint8_t>() );
+   BOOST_REQUIRE      ( 0 <        get_rex_exec_cursor()["order_time"].as<uint64_t>() );
+
+   {
+      auto trace  = base_tester::push_action( config::system_account_name, "rexexec2"_n, frank,
+                                              mvo()("user", frank)("budget", 2) );
+      auto output = get_rexorders_result( trace );
+      BOOST_REQUIRE_EQUAL( 1,      output.size() );
+      BOOST_REQUIRE_EQUAL( alice,  output[0].first );
+   }
+   BOOST_REQUIRE_EQUAL( false,     get_rex_order(alice)["is_open"].as<bool>() );
+   BOOST_REQUIRE_EQUAL( 0,         get_rex_exec_cursor()["stage"].as<uint8_t>() );
+   BOOST_REQUIRE_EQUAL( 0,         get_rex_exec_cursor()["order_time"].as<uint64_t>() );
+
+} FC_LOG_AND_RETHROW()
+
+
 BOOST_FIXTURE_TEST_CASE( rex_loans, eosio_system_tester ) try {
 
    const int64_t ratio        = 10000;
@@ -4617,6 +4946,8 @@ BOOST_FIXTURE_TEST_CASE( ramfee_namebid_to_rex, eosio_system_tester ) try {
    BOOST_REQUIRE_EQUAL( success(),                        bidname( carol, "rndmbid"_n, core_sym::from_string("23.7000") ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("23.7000"), get_balance( "eosio.names"_n ) );
    BOOST_REQUIRE_EQUAL( success(),                        bidname( alice, "rndmbid"_n, core_sym::from_string("29.3500") ) );
+   BOOST_REQUIRE_EQUAL( core_sym::from_string("53.0500"), get_balance( "eosio.names"_n ));
+   BOOST_REQUIRE_EQUAL( success(),                        bidrefunds( carol ) );
    BOOST_REQUIRE_EQUAL( core_sym::from_string("29.3500"), get_balance( "eosio.names"_n ));
 
    produce_block( fc::hours(24) );
@@ -5055,9 +5386,44 @@ BOOST_FIXTURE_TEST_CASE( update_rex, eosio_system_tester, * boost::unit_test::to
    BOOST_TEST_REQUIRE( get_producer_info(producer_names[20])["total_votes"].as<double>()
                        < stake2votes( asset( get_voter_info( alice )["staked"].as<int64_t>(), symbol{CORE_SYM} ) ) );
 
+   auto alice_votes_synced = [&]() {
+      return stake2votes( asset( get_voter_info( alice )["staked"].as<int64_t>(), symbol{CORE_SYM} ) )
+             == get_producer_info(producer_names[20])["total_votes"].as<double>();
+   };
+   auto alice_queued = [&]() {
+      return !get_row_by_account( config::system_account_name, config::system_account_name,
+                                  "rexvotesync"_n, alice ).empty();
+   };
+
+   // drift below 1% of alice's stake is only added to her stake
    BOOST_REQUIRE_EQUAL( success(), updaterex( alice ) );
-   BOOST_TEST_REQUIRE( stake2votes( asset( get_voter_info( alice )["staked"].as<int64_t>(), symbol{CORE_SYM} ) )
-                       == get_producer_info(producer_names[20])["total_votes"].as<double>() );
+   BOOST_REQUIRE_EQUAL( false,     alice_queued() );
+   BOOST_REQUIRE_EQUAL( false,     alice_votes_synced() );
+   BOOST_TEST_REQUIRE( 0 < get_voter_info( alice )["unsynced_rex_stake"].as<asset>().get_amount() );
+
+   // voteproducer settles the drift
+   BOOST_REQUIRE_EQUAL( success(), vote( alice, { producer_names.begin(), producer_names.begin() + 21 } ) );
+   BOOST_REQUIRE_EQUAL( 0,         get_voter_info( alice )["unsynced_rex_stake"].as<asset>().get_amount() );
+   BOOST_REQUIRE_EQUAL( true,      alice_votes_synced() );
+
+   // once the drift reaches 1% of alice's stake, alice is queued and settled by syncrexvotes
+   BOOST_REQUIRE_EQUAL( success(), rentcpu( emily, bob, core_sym::from_string("3000.0000") ) );
+   produce_block( fc::days(3) );
+   BOOST_REQUIRE_EQUAL( success(), updaterex( alice ) );
+   BOOST_REQUIRE_EQUAL( true,      alice_queued() );
+   BOOST_REQUIRE_EQUAL( false,     alice_votes_synced() );
+   BOOST_REQUIRE_EQUAL( success(), syncrexvotes( bob, 10 ) );
+   BOOST_REQUIRE_EQUAL( false,     alice_queued() );
+   BOOST_REQUIRE_EQUAL( 0,         get_voter_info( alice )["unsynced_rex_stake"].as<asset>().get_amount() );
+   BOOST_REQUIRE_EQUAL( true,      alice_votes_synced() );
+
+   // or by the next block
+   produce_block( fc::days(3) );
+   BOOST_REQUIRE_EQUAL( success(), updaterex( alice ) );
+   BOOST_REQUIRE_EQUAL( true,      alice_queued() );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( false,     alice_queued() );
+   BOOST_REQUIRE_EQUAL( true,      alice_votes_synced() );
 
    produce_block( fc::hours(19 * 24 + 23) );
    BOOST_REQUIRE_EQUAL( success(),                                       rexexec( alice, 1 ) );
@@ -5300,6 +5666,137 @@ BOOST_FIXTURE_TEST_CASE( close_rex, eosio_system_tester ) try {
 } FC_LOG_AND_RETHROW()
 
 
+BOOST_FIXTURE_TEST_CASE( migrate_rex, eosio_system_tester ) try {
+
+   // legacy `rexfund` and `rexbal` rows are written by a contract which predates `rexaccount`
+   set_code( config::system_account_name, contracts::util::system_wasm_v1_8() );
+   set_abi(  config::system_account_name, contracts::util::system_abi_v1_8().data() );
+
+   const asset init_balance = core_sym::from_string("25000.0000");
+   const std::vector<account_name> accounts = { "aliceaccount"_n, "bobbyaccount"_n, "carolaccount"_n,
+                                                "davidaccount"_n, "emilyaccount"_n };
+   account_name alice = accounts[0], bob = accounts[1], carol = accounts[2], david = accounts[3], emily = accounts[4];
+   setup_rex_accounts( accounts, init_balance );
+   const symbol rex_sym( SY(4, REX) );
+
+   for ( const auto& a : { alice, bob, carol, david } ) {
+      BOOST_REQUIRE_EQUAL( success(),      buyrex( a, core_sym::from_string("10000.0000") ) );
+   }
+   produce_block( fc::days(6) );
+
+   set_code( config::system_account_name, contracts::system_wasm() );
+   set_abi(  config::system_account_name, contracts::system_abi().data() );
+   produce_block();
+
+   auto is_legacy = [&]( const account_name& a ) {
+      return !get_legacy_rex_fund_obj( a ).is_null() && get_rex_account_obj( a ).is_null();
+   };
+   auto is_migrated = [&]( const account_name& a ) {
+      return get_legacy_rex_fund_obj( a ).is_null() && get_legacy_rex_balance_obj( a ).is_null() &&
+             !get_rex_account_obj( a ).is_null();
+   };
+   for ( const auto& a : accounts ) {
+      BOOST_REQUIRE( is_legacy( a ) );
+   }
+
+   const asset alice_rex   = get_rex_balance( alice );
+   const asset alice_fund  = get_rex_fund( alice );
+   const asset alice_stake = get_rex_vote_stake( alice );
+
+   BOOST_REQUIRE_EQUAL( success(),         migraterex( alice ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("REX account has already been migrated"), migraterex( alice ) );
+   BOOST_REQUIRE      ( is_migrated( alice ) );
+   {
+      auto racct = get_rex_account_obj( alice );
+      BOOST_REQUIRE_EQUAL( alice_fund,     racct["fund"].as<asset>() );
+      BOOST_REQUIRE_EQUAL( alice_rex,      racct["rex_balance"].as<asset>() );
+      BOOST_REQUIRE_EQUAL( alice_stake,    racct["vote_stake"].as<asset>() );
+      BOOST_REQUIRE_EQUAL( alice_rex.get_amount(), racct["matured_rex"].as<int64_t>() );
+      BOOST_REQUIRE_EQUAL( 0,              racct["savings_rex"].as<int64_t>() );
+      const auto maturing = racct["maturing_rex"].as<std::vector<int64_t>>();
+      BOOST_REQUIRE_EQUAL( 5,              maturing.size() );
+      for ( const auto rex : maturing ) {
+         BOOST_REQUIRE_EQUAL( 0,           rex );
+      }
+   }
+
+   // the first write of any REX action moves the legacy rows into a single `rexaccount` row
+   const asset bob_rex = get_rex_balance( bob );
+   BOOST_REQUIRE_EQUAL( success(),         buyrex( bob, core_sym::from_string("1000.0000") ) );
+   BOOST_REQUIRE      ( is_migrated( bob ) );
+   BOOST_REQUIRE      ( bob_rex < get_rex_account_obj( bob )["rex_balance"].as<asset>() );
+   BOOST_REQUIRE_EQUAL( bob_rex.get_amount(), get_rex_account_obj( bob )["matured_rex"].as<int64_t>() );
+
+   const asset carol_rex = get_rex_balance( carol );
+   BOOST_REQUIRE_EQUAL( success(),         sellrex( carol, asset( carol_rex.get_amount() / 2, rex_sym ) ) );
+   BOOST_REQUIRE      ( is_migrated( carol ) );
+   BOOST_REQUIRE_EQUAL( asset( carol_rex.get_amount() - carol_rex.get_amount() / 2, rex_sym ),
+                        get_rex_account_obj( carol )["rex_balance"].as<asset>() );
+
+   const asset david_fund = get_rex_fund( david );
+   BOOST_REQUIRE_EQUAL( success(),         withdraw( david, core_sym::from_string("100.0000") ) );
+   BOOST_REQUIRE      ( is_migrated( david ) );
+   BOOST_REQUIRE_EQUAL( david_fund - core_sym::from_string("100.0000"), get_rex_account_obj( david )["fund"].as<asset>() );
+
+   // savings are kept outside the maturity slots
+   BOOST_REQUIRE_EQUAL( success(),         mvtosavings( alice, asset( 1000, rex_sym ) ) );
+   BOOST_REQUIRE_EQUAL( 1000,              get_rex_account_obj( alice )["savings_rex"].as<int64_t>() );
+   BOOST_REQUIRE_EQUAL( success(),         mvfrsavings( alice, asset( 1000, rex_sym ) ) );
+   BOOST_REQUIRE_EQUAL( 0,                 get_rex_account_obj( alice )["savings_rex"].as<int64_t>() );
+
+   BOOST_REQUIRE_EQUAL( success(),         sellrex( alice, get_rex_account_obj( alice )["rex_balance"].as<asset>() ) );
+   BOOST_REQUIRE_EQUAL( success(),         withdraw( alice, get_rex_account_obj( alice )["fund"].as<asset>() ) );
+   BOOST_REQUIRE_EQUAL( success(),         closerex( alice ) );
+   BOOST_REQUIRE_EQUAL( true,              get_rex_account_obj( alice ).is_null() );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("account has no REX fund or REX balance"), migraterex( alice ) );
+
+   // a fund-only account is migrated as well
+   BOOST_REQUIRE_EQUAL( success(),         withdraw( emily, core_sym::from_string("1.0000") ) );
+   BOOST_REQUIRE      ( is_migrated( emily ) );
+   BOOST_REQUIRE_EQUAL( init_balance - core_sym::from_string("1.0000"), get_rex_account_obj( emily )["fund"].as<asset>() );
+
+} FC_LOG_AND_RETHROW()
+
+
+BOOST_FIXTURE_TEST_CASE( rex_maturity_ring, eosio_system_tester ) try {
+
+   const asset init_balance = core_sym::from_string("10000.0000");
+   const std::vector<account_name> accounts = { "aliceaccount"_n };
+   account_name alice = accounts[0];
+   setup_rex_accounts( accounts, init_balance );
+
+   // purchases on more days than there are slots; each matures 5 days after the day it was bought
+   std::vector<int64_t> bought;
+   for ( uint32_t day = 0; day < 8; ++day ) {
+      const int64_t before = get_rex_balance( alice ).get_amount();
+      BOOST_REQUIRE_EQUAL( success(), buyrex( alice, core_sym::from_string("100.0000") ) );
+      bought.push_back( get_rex_balance( alice ).get_amount() - before );
+
+      int64_t matured = 0, maturing = 0;
+      for ( uint32_t d = 0; d <= day; ++d ) {
+         ( d + 5 <= day ? matured : maturing ) += bought[d];
+      }
+      auto racct = get_rex_account_obj( alice );
+      const auto slots = racct["maturing_rex"].as<std::vector<int64_t>>();
+      BOOST_REQUIRE_EQUAL( 5u,       slots.size() );
+      BOOST_REQUIRE_EQUAL( matured,  racct["matured_rex"].as<int64_t>() );
+      BOOST_REQUIRE_EQUAL( maturing, std::accumulate( slots.begin(), slots.end(), int64_t(0) ) );
+      BOOST_REQUIRE_EQUAL( std::min<size_t>( day + 1, 5 ), get_rex_balance_obj( alice )["rex_maturities"].get_array().size() );
+
+      produce_block( fc::days(1) );
+   }
+
+   // the ring is folded when no purchase happened for longer than the slots cover
+   produce_block( fc::days(10) );
+   BOOST_REQUIRE_EQUAL( success(), sellrex( alice, asset( bought[0], symbol( SY(4, REX) ) ) ) );
+   auto racct = get_rex_account_obj( alice );
+   const auto slots = racct["maturing_rex"].as<std::vector<int64_t>>();
+   BOOST_REQUIRE_EQUAL( 0,  std::accumulate( slots.begin(), slots.end(), int64_t(0) ) );
+   BOOST_REQUIRE_EQUAL( std::accumulate( bought.begin(), bought.end(), int64_t(0) ) - bought[0], racct["matured_rex"].as<int64_t>() );
+
+} FC_LOG_AND_RETHROW()
+
+
 BOOST_FIXTURE_TEST_CASE( set_rex, eosio_system_tester ) try {
 
    const asset init_balance = core_sym::from_string("25000.0000");
@@ -5610,6 +6107,17 @@ BOOST_FIXTURE_TEST_CASE( setabi, eosio_system_tester ) try {
       BOOST_REQUIRE( abi_hash.hash == result );
    }
 
+   // setting the same abi again keeps the row, including its size
+   set_abi( "eosio.token"_n, contracts::system_abi().data() );
+   {
+      auto res = get_row_by_account( config::system_account_name, config::system_account_name, "abihash"_n, "eosio.token"_n );
+      auto abi_hash_var = abi_ser.binary_to_variant( "abi_hash", res, abi_serializer::create_yield_function(abi_serializer_max_time) );
+      auto abi = fc::raw::pack(fc::json::from_string( (const char*)contracts::system_abi().data()).template as<abi_def>());
+
+      BOOST_REQUIRE( abi_hash_var["hash"].as<fc::sha256>() == fc::sha256::hash( (const char*)abi.data(), abi.size() ) );
+      BOOST_REQUIRE_EQUAL( abi.size(), abi_hash_var["size"].as_uint64() );
+   }
+
 } FC_LOG_AND_RETHROW()
 
 BOOST_FIXTURE_TEST_CASE( change_limited_account_back_to_unlimited, eosio_system_tester ) try {
@@ -5751,4 +6259,70 @@ BOOST_FIXTURE_TEST_CASE( buy_pin_sell_ram, eosio_system_tester ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE( set_account_limits_in_bulk, eosio_system_tester ) try {
+   const auto& rlm = control->get_resource_limits_manager();
+   int64_t ram_bytes = 0, net_weight = 0, cpu_weight = 0;
+
+   auto setacctlims = [&]( const account_name& signer, const vector<fc::variant>& limits ) {
+      return push_action( signer, "setacctlims"_n, mvo()("limits", limits) );
+   };
+
+   BOOST_REQUIRE_EQUAL( error("missing authority of eosio"),
+                        setacctlims( "alice1111111"_n, { mvo()("account", "alice1111111")("ram_bytes", 1000000)("net_weight", 5)("cpu_weight", 7) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg("not allowed to set RAM limit to unlimited"),
+                        setacctlims( "eosio"_n, { mvo()("account", "alice1111111")("ram_bytes", -1)("net_weight", 5)("cpu_weight", 7) } ) );
+
+   BOOST_REQUIRE_EQUAL( success(), setacctlims( "eosio"_n, {
+      mvo()("account", "alice1111111")("ram_bytes", 1000000)("net_weight", 5)("cpu_weight", 7),
+      mvo()("account", "bob111111111")("ram_bytes", fc::variant())("net_weight", -1)("cpu_weight", fc::variant())
+   } ) );
+
+   rlm.get_account_limits( "alice1111111"_n, ram_bytes, net_weight, cpu_weight );
+   BOOST_REQUIRE_EQUAL( 1000000, ram_bytes );
+   BOOST_REQUIRE_EQUAL( 5, net_weight );
+   BOOST_REQUIRE_EQUAL( 7, cpu_weight );
+   BOOST_REQUIRE_EQUAL( 7u, get_voter_info( "alice1111111" )["flags1"].as_uint64() );
+
+   auto bob_res = get_total_stake( "bob111111111" );
+   rlm.get_account_limits( "bob111111111"_n, ram_bytes, net_weight, cpu_weight );
+   BOOST_REQUIRE_EQUAL( -1, net_weight );
+   BOOST_REQUIRE_EQUAL( bob_res["cpu_weight"].as<asset>().get_amount(), cpu_weight );
+   BOOST_REQUIRE_EQUAL( 2u, get_voter_info( "bob111111111" )["flags1"].as_uint64() );
+
+   // empty fields unpin pinned resources and keep the others as they are
+   int64_t bob_ram = 0, bob_cpu = 0;
+   rlm.get_account_limits( "bob111111111"_n, bob_ram, net_weight, bob_cpu );
+   BOOST_REQUIRE_EQUAL( success(), setacctlims( "eosio"_n, {
+      mvo()("account", "alice1111111")("ram_bytes", fc::variant())("net_weight", fc::variant())("cpu_weight", fc::variant()),
+      mvo()("account", "bob111111111")("ram_bytes", fc::variant())("net_weight", fc::variant())("cpu_weight", fc::variant())
+   } ) );
+
+   auto alice_res = get_total_stake( "alice1111111" );
+   rlm.get_account_limits( "alice1111111"_n, ram_bytes, net_weight, cpu_weight );
+   BOOST_REQUIRE_EQUAL( alice_res["net_weight"].as<asset>().get_amount(), net_weight );
+   BOOST_REQUIRE_EQUAL( alice_res["cpu_weight"].as<asset>().get_amount(), cpu_weight );
+   BOOST_REQUIRE_EQUAL( 0u, get_voter_info( "alice1111111" )["flags1"].as_uint64() );
+   rlm.get_account_limits( "bob111111111"_n, ram_bytes, net_weight, cpu_weight );
+   BOOST_REQUIRE_EQUAL( bob_ram, ram_bytes );
+   BOOST_REQUIRE_EQUAL( bob_res["net_weight"].as<asset>().get_amount(), net_weight );
+   BOOST_REQUIRE_EQUAL( bob_cpu, cpu_weight );
+   BOOST_REQUIRE_EQUAL( 0u, get_voter_info( "bob111111111" )["flags1"].as_uint64() );
+
+   // limits set by setalimits survive an empty field
+   BOOST_REQUIRE_EQUAL( success(), push_action( "eosio"_n, "setalimits"_n, mvo()
+                                                ("account", "eosio.stake")
+                                                ("ram_bytes", -1)
+                                                ("net_weight", 5)
+                                                ("cpu_weight", 7) ) );
+   BOOST_REQUIRE_EQUAL( success(), setacctlims( "eosio"_n, {
+      mvo()("account", "eosio.stake")("ram_bytes", fc::variant())("net_weight", 10)("cpu_weight", fc::variant())
+   } ) );
+   rlm.get_account_limits( "eosio.stake"_n, ram_bytes, net_weight, cpu_weight );
+   BOOST_REQUIRE_EQUAL( -1, ram_bytes );
+   BOOST_REQUIRE_EQUAL( 10, net_weight );
+   BOOST_REQUIRE_EQUAL( 7, cpu_weight );
+   BOOST_REQUIRE_EQUAL( 2u, get_voter_info( "eosio.stake" )["flags1"].as_uint64() );
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file